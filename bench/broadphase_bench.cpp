@@ -0,0 +1,74 @@
+#include "broadphase.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// the world grows with the body count so the density, and with it the
+// number of pairs per body, stays the same
+std::vector<AABB> MakeBounds(size_t count, uint32_t seed) {
+    std::mt19937 rng{seed};
+    float side = std::sqrt(static_cast<float>(count)) * 20.0f;
+    std::uniform_real_distribution<float> position{0, side};
+    std::uniform_real_distribution<float> radius{1, 6};
+
+    std::vector<AABB> bounds(count);
+    for (AABB& b : bounds) {
+        Vec2 center{position(rng), position(rng)};
+        Vec2 extent{radius(rng)};
+        b = {center - extent, center + extent};
+    }
+    return bounds;
+}
+
+// one step: every body moves a little, then the pairs are found
+void BM_FindPairs(benchmark::State& state, BroadphaseType type) {
+    size_t count = static_cast<size_t>(state.range(0));
+    std::vector<AABB> bounds = MakeBounds(count, 1);
+    BroadphasePtr broadphase = CreateBroadphase(type);
+    for (uint32_t i = 0; i < count; i++) {
+        broadphase->Insert(i, bounds[i]);
+    }
+
+    std::vector<BroadphasePair> pairs;
+    float offset = 0.1f;
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < count; i++) {
+            broadphase->Move(i, {bounds[i].m_min + Vec2{offset},
+                                 bounds[i].m_max + Vec2{offset}});
+        }
+        offset = -offset;
+        pairs.clear();
+        broadphase->FindPairs(pairs);
+        benchmark::DoNotOptimize(pairs.data());
+    }
+
+    const BroadphaseStats& stats = broadphase->GetStats();
+    state.counters["pairs"] = static_cast<double>(stats.m_pairCount);
+    state.counters["tests"] = static_cast<double>(stats.m_overlapTests);
+    state.SetComplexityN(state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_FindPairs, BruteForce, BroadphaseType::BruteForce)
+    ->RangeMultiplier(4)
+    ->Range(256, 16384)
+    ->Unit(benchmark::kMicrosecond)
+    ->Complexity();
+BENCHMARK_CAPTURE(BM_FindPairs, UniformGrid, BroadphaseType::UniformGrid)
+    ->RangeMultiplier(4)
+    ->Range(256, 65536)
+    ->Unit(benchmark::kMicrosecond)
+    ->Complexity();
+BENCHMARK_CAPTURE(BM_FindPairs, AABBTree, BroadphaseType::AABBTree)
+    ->RangeMultiplier(4)
+    ->Range(256, 65536)
+    ->Unit(benchmark::kMicrosecond)
+    ->Complexity();
+BENCHMARK_CAPTURE(BM_FindPairs, SweepAndPrune, BroadphaseType::SweepAndPrune)
+    ->RangeMultiplier(4)
+    ->Range(256, 65536)
+    ->Unit(benchmark::kMicrosecond)
+    ->Complexity();
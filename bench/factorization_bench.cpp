@@ -0,0 +1,49 @@
+#include "math/math.hpp"
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+
+Matrix<double> RandomMatrix(size_t n) {
+    std::mt19937 rng{9};
+    std::uniform_real_distribution<double> value{-1, 1};
+    Matrix<double> m(n, n);
+    for (size_t c = 0; c < n; c++) {
+        for (size_t r = 0; r < n; r++) {
+            m[c][r] = value(rng) + (c == r ? 2 : 0);
+        }
+    }
+    return m;
+}
+
+// LU factorization of a copy, O(n^3)
+void BM_Det(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Matrix<double> m = RandomMatrix(n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Det(m));
+    }
+    state.SetComplexityN(state.range(0));
+}
+
+// one LU factorization and n solves
+void BM_Inverse(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Matrix<double> m = RandomMatrix(n);
+    for (auto _ : state) {
+        Matrix<double> inv = Inverse(m);
+        benchmark::DoNotOptimize(inv.Ptr());
+    }
+    state.SetComplexityN(state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_Det)
+    ->RangeMultiplier(2)
+    ->Range(4, 256)
+    ->Complexity(benchmark::oNCubed);
+BENCHMARK(BM_Inverse)
+    ->RangeMultiplier(2)
+    ->Range(4, 256)
+    ->Complexity(benchmark::oNCubed);
@@ -0,0 +1,54 @@
+#include "job_system.hpp"
+#include "math/gemm.hpp"
+#include "math/math.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+
+namespace {
+
+Matrix<float> RandomMatrix(size_t n) {
+    std::mt19937 rng{6};
+    std::uniform_real_distribution<float> value{-1, 1};
+    Matrix<float> m(n, n);
+    for (size_t c = 0; c < n; c++) {
+        for (size_t r = 0; r < n; r++) {
+            m[c][r] = value(rng);
+        }
+    }
+    return m;
+}
+
+/**
+ * @brief square n x n float product, range(1) threads, 1 runs without a
+ * JobSystem
+ */
+void BM_Gemm(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    uint32_t threads = static_cast<uint32_t>(state.range(1));
+    std::unique_ptr<JobSystem> jobSystem;
+    if (threads > 1) {
+        jobSystem = std::make_unique<JobSystem>(threads);
+    }
+
+    Matrix<float> a = RandomMatrix(n);
+    Matrix<float> b = RandomMatrix(n);
+    Matrix<float> c(n, n);
+    for (auto _ : state) {
+        Gemm(MatrixView<float, true>{a}, MatrixView<float, true>{b},
+             MatrixView<float, false>{c}, jobSystem.get());
+        benchmark::DoNotOptimize(c.Ptr());
+        benchmark::ClobberMemory();
+    }
+    state.counters["flops"] = benchmark::Counter(
+        2.0 * static_cast<double>(n * n * n),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+}  // namespace
+
+BENCHMARK(BM_Gemm)
+    ->ArgNames({"n", "threads"})
+    ->ArgsProduct({benchmark::CreateRange(64, 2048, 2), {1, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
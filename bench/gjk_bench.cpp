@@ -0,0 +1,130 @@
+#include "contact.hpp"
+#include "gjk.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+
+namespace {
+
+constexpr size_t PoseCount = 256;
+
+ShapePolygon MakeOctagon(float radius) {
+    Vec2 points[8];
+    for (int i = 0; i < 8; i++) {
+        float angle = 2 * PI * i / 8;
+        points[i] = Vec2{radius * std::cos(angle), radius * std::sin(angle)};
+    }
+    return ShapePolygon{points, 8};
+}
+
+// poses of B with its center at a random distance from A at the origin,
+// turned at random
+std::vector<Transform2D> MakePoses(float minDistance, float maxDistance) {
+    std::mt19937 rng{3};
+    std::uniform_real_distribution<float> angle{0, 2 * PI};
+    std::uniform_real_distribution<float> distance{minDistance, maxDistance};
+
+    std::vector<Transform2D> poses(PoseCount);
+    for (Transform2D& pose : poses) {
+        float direction = angle(rng);
+        float d = distance(rng);
+        Vec2 position{d * std::cos(direction), d * std::sin(direction)};
+        pose = Transform2D{position, Rotation2D{angle(rng)}};
+    }
+    return poses;
+}
+
+/**
+ * @brief GJK distance of separated cores
+ * @param warm  start every query from the simplex the same pair ended with,
+ * as the narrowphase does between steps
+ */
+template <typename A, typename B>
+void RunGjkDistance(benchmark::State& state, const A& a, const B& b,
+                    bool warm) {
+    std::vector<Transform2D> poses = MakePoses(2.5f, 4.0f);
+    std::vector<GjkSimplex> simplices(PoseCount);
+    ConvexProxy proxyA{a, Transform2D{Vec2{0, 0}, Rotation2D{}}};
+
+    uint64_t iterations = 0;
+    size_t i = 0;
+    for (auto _ : state) {
+        GjkSimplex& simplex = simplices[i];
+        if (!warm) {
+            simplex.m_count = 0;
+        }
+        GjkResult result =
+            GjkDistance(proxyA, ConvexProxy{b, poses[i]}, simplex);
+        benchmark::DoNotOptimize(result);
+        iterations += result.m_iterations;
+        i = (i + 1) % PoseCount;
+    }
+    state.counters["gjk_iterations"] = benchmark::Counter(
+        static_cast<double>(iterations), benchmark::Counter::kAvgIterations);
+}
+
+void BM_GjkDistanceOctagons(benchmark::State& state) {
+    ShapePolygon octagon = MakeOctagon(1);
+    RunGjkDistance(state, octagon, octagon, state.range(0) != 0);
+}
+
+void BM_GjkDistanceRoundedBoxCapsule(benchmark::State& state) {
+    ShapeRoundedBox box{0.8f, 0.8f, 0.2f};
+    ShapeCapsule capsule{Vec2{-0.8f, 0}, Vec2{0.8f, 0}, 0.2f};
+    RunGjkDistance(state, box, capsule, state.range(0) != 0);
+}
+
+// overlapping cores need EPA after GJK for the penetration
+void BM_GjkEpaOctagons(benchmark::State& state) {
+    ShapePolygon octagon = MakeOctagon(1);
+    std::vector<Transform2D> poses = MakePoses(0.2f, 1.5f);
+    ConvexProxy proxyA{octagon, Transform2D{Vec2{0, 0}, Rotation2D{}}};
+
+    size_t i = 0;
+    for (auto _ : state) {
+        ConvexProxy proxyB{octagon, poses[i]};
+        GjkSimplex simplex;
+        GjkResult result = GjkDistance(proxyA, proxyB, simplex);
+        Vec2 normal, pointA, pointB;
+        float depth = 0;
+        bool found = EpaPenetration(proxyA, proxyB, simplex, normal, depth,
+                                    pointA, pointB);
+        benchmark::DoNotOptimize(result);
+        benchmark::DoNotOptimize(found);
+        benchmark::DoNotOptimize(depth);
+        i = (i + 1) % PoseCount;
+    }
+}
+
+/**
+ * @brief whole narrowphase of a polygon pair, SAT with clipping against
+ * GJK/EPA through the support mappings
+ */
+void BM_CollidePolygons(benchmark::State& state) {
+    bool sat = state.range(0) != 0;
+    ShapePolygon octagon = MakeOctagon(1);
+    std::vector<Transform2D> poses = MakePoses(1.0f, 2.5f);
+    Transform2D transformA{Vec2{0, 0}, Rotation2D{}};
+
+    size_t i = 0;
+    for (auto _ : state) {
+        CollideCache cache;
+        Contact contacts[MaxManifoldContacts];
+        uint32_t count =
+            sat ? CollidePolygons(octagon, transformA, octagon, poses[i],
+                                  cache, contacts)
+                : CollideConvex(octagon, transformA, octagon, poses[i],
+                                cache, contacts);
+        benchmark::DoNotOptimize(count);
+        benchmark::DoNotOptimize(contacts);
+        i = (i + 1) % PoseCount;
+    }
+    state.SetLabel(sat ? "SAT" : "GJK/EPA");
+}
+
+}  // namespace
+
+BENCHMARK(BM_GjkDistanceOctagons)->ArgName("warm")->Arg(0)->Arg(1);
+BENCHMARK(BM_GjkDistanceRoundedBoxCapsule)->ArgName("warm")->Arg(0)->Arg(1);
+BENCHMARK(BM_GjkEpaOctagons);
+BENCHMARK(BM_CollidePolygons)->ArgName("sat")->Arg(1)->Arg(0);
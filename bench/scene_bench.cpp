@@ -0,0 +1,81 @@
+#include "scene.hpp"
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace {
+
+constexpr float TimeStep = 1.0f / 60.0f;
+
+// a brick laid box pile solved as one large island and spheres falling on
+// static bumps
+void BuildScene(PhysicsScene& scene) {
+    scene.m_gravity = Vec2{0, 100};
+    scene.SetAllowSleep(false);
+
+    BodyHandle ground = scene.CreateBody(ShapePolygon::Box(400, 5));
+    scene.GetBody(ground).Position() = Vec2{200, 5};
+    scene.GetBody(ground).InvMass() = 0;
+    for (int y = 0; y < 20; y++) {
+        for (int x = 0; x < 40; x++) {
+            BodyHandle box = scene.CreateBody(ShapePolygon::Box(5, 5));
+            Body body = scene.GetBody(box);
+            body.Position() =
+                Vec2{x * 10.5f + 5.25f * (y % 2), -5 - y * 10.5f};
+            body.Elasticity() = 0;
+        }
+    }
+
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> x{1000, 17000};
+    std::uniform_real_distribution<float> y{-3000, 0};
+    std::uniform_real_distribution<float> radius{2, 5};
+    for (int i = 0; i < 80; i++) {
+        Body bump = scene.GetBody(scene.CreateBody(ShapeSphere{60}));
+        bump.Position() = Vec2{1000 + i * 200.0f, 60};
+        bump.InvMass() = 0;
+    }
+    for (int i = 0; i < 20000; i++) {
+        BodyHandle handle = scene.CreateBody(ShapeSphere{radius(rng)});
+        Body sphere = scene.GetBody(handle);
+        sphere.Position() = Vec2{x(rng), y(rng)};
+    }
+}
+
+// one Update at range(0) threads, compare the times across thread counts
+// for the speedup
+void BM_Update(benchmark::State& state) {
+    PhysicsScene scene;
+    scene.SetThreadCount(static_cast<uint32_t>(state.range(0)));
+    BuildScene(scene);
+    // let the spheres land so the step has contacts to solve
+    for (int i = 0; i < 60; i++) {
+        scene.Update(TimeStep);
+    }
+
+    double broadphaseMs = 0;
+    double narrowphaseMs = 0;
+    double solverMs = 0;
+    for (auto _ : state) {
+        scene.Update(TimeStep);
+        const StepStats& stats = scene.GetStepStats();
+        broadphaseMs += stats.m_broadphaseMs;
+        narrowphaseMs += stats.m_narrowphaseMs;
+        solverMs += stats.m_solverMs;
+    }
+
+    using benchmark::Counter;
+    state.counters["broadphase_ms"] =
+        Counter(broadphaseMs, Counter::kAvgIterations);
+    state.counters["narrowphase_ms"] =
+        Counter(narrowphaseMs, Counter::kAvgIterations);
+    state.counters["solver_ms"] = Counter(solverMs, Counter::kAvgIterations);
+    state.counters["islands"] = scene.GetStepStats().m_islandCount;
+}
+
+}  // namespace
+
+BENCHMARK(BM_Update)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
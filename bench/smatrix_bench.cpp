@@ -0,0 +1,102 @@
+#include "math/math.hpp"
+#include <benchmark/benchmark.h>
+#include <random>
+
+// each SSE/AVX overload against the generic template it replaces, reached by
+// naming the template arguments
+
+namespace {
+
+constexpr size_t Count = 256;
+
+struct Inputs {
+    std::vector<Mat44> m_matrices;
+    std::vector<Vec4> m_vectors;
+
+    Inputs() : m_matrices(Count), m_vectors(Count) {
+        std::mt19937 rng{5};
+        std::uniform_real_distribution<float> value{-1, 1};
+        for (size_t i = 0; i < Count; i++) {
+            for (size_t c = 0; c < 4; c++) {
+                for (size_t r = 0; r < 4; r++) {
+                    m_matrices[i][c][r] = value(rng);
+                }
+            }
+            m_vectors[i] =
+                Vec4{value(rng), value(rng), value(rng), value(rng)};
+        }
+    }
+};
+
+const char* Label(bool simd) { return simd ? "simd" : "scalar"; }
+
+// a sum of products of Count vector pairs
+template <bool Simd>
+void BM_Vec4MulAdd(benchmark::State& state) {
+    Inputs inputs;
+    const std::vector<Vec4>& v = inputs.m_vectors;
+    for (auto _ : state) {
+        Vec4 sum;
+        for (size_t i = 0; i + 1 < Count; i++) {
+            if constexpr (Simd) {
+                sum = sum + v[i] * v[i + 1];
+            } else {
+                sum = operator+ <float, 4>(
+                    sum, operator* <float, 4>(v[i], v[i + 1]));
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * (Count - 1));
+    state.SetLabel(Label(Simd));
+}
+
+template <bool Simd>
+void BM_Mat44MulVec4(benchmark::State& state) {
+    Inputs inputs;
+    std::vector<Vec4> out(Count);
+    for (auto _ : state) {
+        for (size_t i = 0; i < Count; i++) {
+            const Mat44& m = inputs.m_matrices[i];
+            const Vec4& v = inputs.m_vectors[i];
+            if constexpr (Simd) {
+                out[i] = m * v;
+            } else {
+                out[i] = operator* <float, 4, 4>(m, v);
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * Count);
+    state.SetLabel(Label(Simd));
+}
+
+template <bool Simd>
+void BM_Mat44MulMat44(benchmark::State& state) {
+    Inputs inputs;
+    const std::vector<Mat44>& m = inputs.m_matrices;
+    std::vector<Mat44> out(Count);
+    for (auto _ : state) {
+        for (size_t i = 0; i + 1 < Count; i++) {
+            if constexpr (Simd) {
+                out[i] = m[i] * m[i + 1];
+            } else {
+                out[i] = operator* <float, 4, 4, 4>(m[i], m[i + 1]);
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * (Count - 1));
+    state.SetLabel(Label(Simd));
+}
+
+}  // namespace
+
+BENCHMARK(BM_Vec4MulAdd<false>);
+BENCHMARK(BM_Vec4MulAdd<true>);
+BENCHMARK(BM_Mat44MulVec4<false>);
+BENCHMARK(BM_Mat44MulVec4<true>);
+BENCHMARK(BM_Mat44MulMat44<false>);
+BENCHMARK(BM_Mat44MulMat44<true>);
@@ -0,0 +1,101 @@
+#include "math/math.hpp"
+#include <benchmark/benchmark.h>
+#include <limits>
+#include <random>
+
+namespace {
+
+// 2D Laplacian on a side x side grid, a few nonzeros per row like a
+// constraint system
+SparseMatrix<double> GridMatrix(size_t side) {
+    std::vector<SparseEntry<double>> entries;
+    for (size_t i = 0; i < side; i++) {
+        for (size_t j = 0; j < side; j++) {
+            size_t r = i * side + j;
+            entries.push_back({r, r, 4.5});
+            if (i > 0) entries.push_back({r - side, r, -1});
+            if (i + 1 < side) entries.push_back({r + side, r, -1});
+            if (j > 0) entries.push_back({r - 1, r, -1});
+            if (j + 1 < side) entries.push_back({r + 1, r, -1});
+        }
+    }
+    size_t n = side * side;
+    return SparseMatrix<double>::FromEntries(n, n, std::move(entries));
+}
+
+std::vector<double> RandomVector(size_t n) {
+    std::mt19937 rng{8};
+    std::uniform_real_distribution<double> value{-1, 1};
+    std::vector<double> v(n);
+    for (double& x : v) {
+        x = value(rng);
+    }
+    return v;
+}
+
+// range(0) is the grid side, so n = side^2 unknowns
+void BM_ConjugateGradient(benchmark::State& state) {
+    SparseMatrix<double> a = GridMatrix(static_cast<size_t>(state.range(0)));
+    std::vector<double> b = RandomVector(a.RowNum());
+    uint32_t iterations = 0;
+    for (auto _ : state) {
+        std::vector<double> x(a.RowNum(), 0);
+        iterations = ConjugateGradient(a, b, x, 1000, 1e-10).iterations;
+        benchmark::DoNotOptimize(x.data());
+    }
+    state.counters["n"] = static_cast<double>(a.RowNum());
+    state.counters["iterations"] = iterations;
+}
+
+void BM_ProjectedGaussSeidel(benchmark::State& state) {
+    SparseMatrix<double> a = GridMatrix(static_cast<size_t>(state.range(0)));
+    std::vector<double> b = RandomVector(a.RowNum());
+    constexpr double Inf = std::numeric_limits<double>::infinity();
+    std::vector<double> lo(a.RowNum(), -Inf);
+    std::vector<double> hi(a.RowNum(), Inf);
+    uint32_t iterations = 0;
+    for (auto _ : state) {
+        std::vector<double> x(a.RowNum(), 0);
+        iterations =
+            ProjectedGaussSeidel(a, b, lo, hi, x, 10000, 1e-10).iterations;
+        benchmark::DoNotOptimize(x.data());
+    }
+    state.counters["n"] = static_cast<double>(a.RowNum());
+    state.counters["iterations"] = iterations;
+}
+
+// the same system stored dense and solved by Solve on the augmented matrix
+void BM_DenseSolve(benchmark::State& state) {
+    SparseMatrix<double> a = GridMatrix(static_cast<size_t>(state.range(0)));
+    std::vector<double> b = RandomVector(a.RowNum());
+    size_t n = a.RowNum();
+    Matrix<double> augmented(n + 1, n);
+    for (size_t r = 0; r < n; r++) {
+        for (uint32_t k = a.RowStarts()[r]; k < a.RowStarts()[r + 1]; k++) {
+            augmented[a.ColIndices()[k]][r] = a.Values()[k];
+        }
+        augmented[n][r] = b[r];
+    }
+    for (auto _ : state) {
+        Matrix<double> m = augmented;
+        auto x = Solve(MatrixView<double, false>{m});
+        benchmark::DoNotOptimize(x);
+    }
+    state.counters["n"] = static_cast<double>(n);
+}
+
+}  // namespace
+
+BENCHMARK(BM_ConjugateGradient)
+    ->RangeMultiplier(2)
+    ->Range(8, 128)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ProjectedGaussSeidel)
+    ->RangeMultiplier(2)
+    ->Range(8, 128)
+    ->Unit(benchmark::kMicrosecond);
+// O(n^3) in the unknowns, a 32 side grid already takes seconds
+BENCHMARK(BM_DenseSolve)
+    ->RangeMultiplier(2)
+    ->Range(8, 16)
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,88 @@
+#include "scene.hpp"
+#include <benchmark/benchmark.h>
+
+#ifdef COUNT_TRIG_CALLS
+// the linker sends every cosf/sinf/sincosf call of the engine through these
+extern "C" {
+float __real_cosf(float x);
+float __real_sinf(float x);
+void __real_sincosf(float x, float* s, float* c);
+
+uint64_t g_trigCalls = 0;
+
+float __wrap_cosf(float x) {
+    g_trigCalls++;
+    return __real_cosf(x);
+}
+
+float __wrap_sinf(float x) {
+    g_trigCalls++;
+    return __real_sinf(x);
+}
+
+void __wrap_sincosf(float x, float* s, float* c) {
+    g_trigCalls += 2;
+    __real_sincosf(x, s, c);
+}
+}
+#endif
+
+namespace {
+
+constexpr float TimeStep = 1.0f / 60.0f;
+
+// a pile of every convex shape type, turning as it settles on the ground
+void BuildScene(PhysicsScene& scene) {
+    scene.m_gravity = Vec2{0, 100};
+    scene.SetAllowSleep(false);
+
+    Body ground = scene.GetBody(scene.CreateBody(ShapePolygon::Box(400, 5)));
+    ground.Position() = Vec2{0, 5};
+    ground.InvMass() = 0;
+
+    ShapeHandle shapes[] = {
+        scene.CreateShape(ShapePolygon::Box(3, 3)),
+        scene.CreateShape(ShapeSphere{3}),
+        scene.CreateShape(ShapeCapsule{Vec2{-3, 0}, Vec2{3, 0}, 1.5f}),
+        scene.CreateShape(ShapeRoundedBox{2, 2, 1}),
+    };
+    for (int i = 0; i < 400; i++) {
+        Body body = scene.GetBody(scene.CreateBody(shapes[i % 4]));
+        body.Position() = Vec2{-300.0f + (i % 40) * 15, -10.0f - (i / 40) * 12};
+    }
+}
+
+/**
+ * @brief cos/sin evaluated per step, only bodies whose rotation changed
+ * should need them, not every transform built by the narrowphase
+ */
+void BM_StepTrigCalls(benchmark::State& state) {
+    PhysicsScene scene;
+    BuildScene(scene);
+    for (int i = 0; i < 120; i++) {
+        scene.Update(TimeStep);
+    }
+
+    uint64_t rotationUpdates = 0;
+#ifdef COUNT_TRIG_CALLS
+    uint64_t trigCalls = g_trigCalls;
+#endif
+    for (auto _ : state) {
+        scene.Update(TimeStep);
+        rotationUpdates += scene.GetStepStats().m_rotationUpdates;
+    }
+
+    using benchmark::Counter;
+    state.counters["rotation_updates"] =
+        Counter(static_cast<double>(rotationUpdates), Counter::kAvgIterations);
+#ifdef COUNT_TRIG_CALLS
+    state.counters["trig_calls"] = Counter(
+        static_cast<double>(g_trigCalls - trigCalls), Counter::kAvgIterations);
+#endif
+    state.counters["manifolds"] =
+        static_cast<double>(scene.GetManifolds().size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_StepTrigCalls)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,69 @@
+#pragma once
+#include "macro.hpp"
+#include "math/math.hpp"
+#include <algorithm>
+#include <limits>
+
+struct AABB {
+    Vec2 m_min;
+    Vec2 m_max;
+
+    // inverted box that intersects nothing
+    static AABB Empty() {
+        constexpr float max = std::numeric_limits<float>::max();
+        return {Vec2{max}, Vec2{-max}};
+    }
+
+    static AABB Merge(const AABB& a, const AABB& b) {
+        return {Vec2{std::min(a.m_min.x, b.m_min.x),
+                     std::min(a.m_min.y, b.m_min.y)},
+                Vec2{std::max(a.m_max.x, b.m_max.x),
+                     std::max(a.m_max.y, b.m_max.y)}};
+    }
+
+    bool IsEmpty() const { return m_min.x > m_max.x || m_min.y > m_max.y; }
+
+    bool IsIntersect(const AABB& o) const {
+        return !(m_min.x > o.m_max.x || m_max.x < o.m_min.x ||
+                 m_min.y > o.m_max.y || m_max.y < o.m_min.y);
+    }
+
+    bool Contains(const AABB& o) const {
+        return m_min.x <= o.m_min.x && m_min.y <= o.m_min.y &&
+               m_max.x >= o.m_max.x && m_max.y >= o.m_max.y;
+    }
+
+    /**
+     * @brief slab test of segment from->to against the box
+     * @param fraction  in: max fraction of the segment, out: entry fraction
+     */
+    bool RayCast(const Vec2& from, const Vec2& to, float& fraction) const {
+        RETURN_FALSE_IF_FALSE(!IsEmpty());
+        Vec2 dir = to - from;
+        float tMin = 0;
+        float tMax = fraction;
+        for (size_t i = 0; i < 2; i++) {
+            if (std::abs(dir[i]) <= std::numeric_limits<float>::epsilon()) {
+                RETURN_FALSE_IF_FALSE(from[i] >= m_min[i] &&
+                                      from[i] <= m_max[i]);
+                continue;
+            }
+            float invDir = 1.0f / dir[i];
+            float t1 = (m_min[i] - from[i]) * invDir;
+            float t2 = (m_max[i] - from[i]) * invDir;
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+            RETURN_FALSE_IF_FALSE(tMin <= tMax);
+        }
+        fraction = tMin;
+        return true;
+    }
+
+    Vec2 GetCenter() const { return (m_min + m_max) * 0.5f; }
+
+    Vec2 GetExtent() const { return m_max - m_min; }
+
+    float GetPerimeter() const {
+        return 2.0f * (m_max.x - m_min.x + m_max.y - m_min.y);
+    }
+};
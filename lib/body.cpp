@@ -1,33 +1,238 @@
 #include "body.hpp"
 #include "macro.hpp"
 
-Vec2 Shape::GetCenterOfMass() const {
-    return m_centerOfMass;
+BodyStorage::BodyStorage(const ShapeStorage& shapes)
+    : m_shapeStorage{&shapes} {}
+
+BodyHandle BodyStorage::Add(ShapeHandle shape) {
+    uint32_t index = static_cast<uint32_t>(Size());
+    m_positions.emplace_back();
+    m_prevPositions.emplace_back();
+    m_linearVels.emplace_back();
+    m_angularVels.push_back(0);
+    // a chain has no area to give it mass, it can only be static
+    m_invMasses.push_back(shape.m_type == ShapeChain::Type ? 0 : 1.0f);
+    m_rotations.push_back(0);
+    m_prevRotations.push_back(0);
+    m_cosSins.emplace_back();
+    m_elasticities.push_back(0.1f);
+    m_frictions.push_back(0.6f);
+    m_shapes.push_back(shape);
+    m_sleepTimes.push_back(0);
+    m_bullets.push_back(0);
+    m_sleepIslands.push_back(BodyHandle::InvalidIndex);
+
+    // inertia matching the default mass of 1
+    float area = shape ? m_shapeStorage->GetArea(shape) : 0;
+    float inertia = shape ? m_shapeStorage->GetInertia(shape) : 0;
+    m_invInertias.push_back(area > 0 && inertia > 0 ? area / inertia : 0);
+    m_localCenters.push_back(
+        shape ? m_shapeStorage->Get(shape).GetCenterOfMass() : Vec2{0, 0});
+
+    uint32_t slot = m_freeSlot;
+    if (slot == BodyHandle::InvalidIndex) {
+        slot = static_cast<uint32_t>(m_slots.size());
+        m_slots.push_back(index);
+        m_generations.push_back(0);
+    } else {
+        m_freeSlot = m_slots[slot];
+        m_slots[slot] = index;
+    }
+    m_indexToSlot.push_back(slot);
+
+    return {slot, m_generations[slot]};
+}
+
+bool BodyStorage::Remove(BodyHandle handle) {
+    uint32_t index = GetIndex(handle);
+    RETURN_FALSE_IF_FALSE(index != BodyHandle::InvalidIndex);
+
+    // islands refer to their bodies, and its neighbours lose their support
+    WakeUp(index);
+
+    // move the last body into the hole to keep arrays dense
+    uint32_t last = static_cast<uint32_t>(Size() - 1);
+    if (index != last) {
+        m_positions[index] = m_positions[last];
+        m_prevPositions[index] = m_prevPositions[last];
+        m_linearVels[index] = m_linearVels[last];
+        m_angularVels[index] = m_angularVels[last];
+        m_invMasses[index] = m_invMasses[last];
+        m_invInertias[index] = m_invInertias[last];
+        m_rotations[index] = m_rotations[last];
+        m_prevRotations[index] = m_prevRotations[last];
+        m_cosSins[index] = m_cosSins[last];
+        m_localCenters[index] = m_localCenters[last];
+        m_elasticities[index] = m_elasticities[last];
+        m_frictions[index] = m_frictions[last];
+        m_shapes[index] = m_shapes[last];
+        m_sleepTimes[index] = m_sleepTimes[last];
+        m_bullets[index] = m_bullets[last];
+        m_sleepIslands[index] = m_sleepIslands[last];
+        m_indexToSlot[index] = m_indexToSlot[last];
+        m_slots[m_indexToSlot[index]] = index;
+    }
+    m_positions.pop_back();
+    m_prevPositions.pop_back();
+    m_linearVels.pop_back();
+    m_angularVels.pop_back();
+    m_invMasses.pop_back();
+    m_invInertias.pop_back();
+    m_rotations.pop_back();
+    m_prevRotations.pop_back();
+    m_cosSins.pop_back();
+    m_localCenters.pop_back();
+    m_elasticities.pop_back();
+    m_frictions.pop_back();
+    m_shapes.pop_back();
+    m_sleepTimes.pop_back();
+    m_bullets.pop_back();
+    m_sleepIslands.pop_back();
+    m_indexToSlot.pop_back();
+
+    uint32_t slot = handle.m_index;
+    m_generations[slot]++;
+    m_slots[slot] = m_freeSlot;
+    m_freeSlot = slot;
+    return true;
+}
+
+bool BodyStorage::IsValid(BodyHandle handle) const {
+    return handle.m_index < m_slots.size() &&
+           m_generations[handle.m_index] == handle.m_generation;
+}
+
+uint32_t BodyStorage::GetIndex(BodyHandle handle) const {
+    RETURN_VALUE_IF_FALSE(IsValid(handle), BodyHandle::InvalidIndex);
+    return m_slots[handle.m_index];
+}
+
+BodyHandle BodyStorage::GetHandle(uint32_t index) const {
+    uint32_t slot = m_indexToSlot[index];
+    return {slot, m_generations[slot]};
+}
+
+void BodyStorage::Reserve(size_t count) {
+    m_positions.reserve(count);
+    m_prevPositions.reserve(count);
+    m_linearVels.reserve(count);
+    m_angularVels.reserve(count);
+    m_invMasses.reserve(count);
+    m_invInertias.reserve(count);
+    m_rotations.reserve(count);
+    m_prevRotations.reserve(count);
+    m_cosSins.reserve(count);
+    m_localCenters.reserve(count);
+    m_elasticities.reserve(count);
+    m_frictions.reserve(count);
+    m_shapes.reserve(count);
+    m_sleepTimes.reserve(count);
+    m_bullets.reserve(count);
+    m_sleepIslands.reserve(count);
+    m_indexToSlot.reserve(count);
+}
+
+AABB BodyStorage::GetBounds(uint32_t index) const {
+    RETURN_DEFAULT_IF_FALSE(m_shapes[index]);
+    return m_shapeStorage->GetBounds(m_shapes[index], GetTransform(index));
 }
 
-ShapeSphere::ShapeSphere(float radius) : m_radius{radius} {}
+void BodyStorage::SetRotation(uint32_t index, float rotation) {
+    m_rotations[index] = rotation;
+    m_cosSins[index] = Rotation2D{rotation};
+}
+
+bool BodyStorage::Integrate(uint32_t index, float delta_time) {
+    Vec2 center = GetCenterOfMass(index) + m_linearVels[index] * delta_time;
+    bool turned = m_angularVels[index] != 0;
+    if (turned) {
+        SetRotation(index,
+                    m_rotations[index] + m_angularVels[index] * delta_time);
+    }
+    m_positions[index] =
+        center - m_cosSins[index].Apply(m_localCenters[index]);
+    return turned;
+}
+
+void BodyStorage::WakeUp(uint32_t index) {
+    uint32_t island = m_sleepIslands[index];
+    RETURN_IF_FALSE(island != BodyHandle::InvalidIndex);
+
+    for (uint32_t slot : m_islandSlots[island]) {
+        uint32_t i = m_slots[slot];
+        m_sleepIslands[i] = BodyHandle::InvalidIndex;
+        m_sleepTimes[i] = 0;
+    }
+    m_islandSlots[island].clear();
+    m_freeIslands.push_back(island);
+}
+
+void BodyStorage::PutToSleep(const uint32_t* indices, size_t count) {
+    RETURN_IF_FALSE(count > 0);
+
+    uint32_t island;
+    if (m_freeIslands.empty()) {
+        island = static_cast<uint32_t>(m_islandSlots.size());
+        m_islandSlots.emplace_back();
+    } else {
+        island = m_freeIslands.back();
+        m_freeIslands.pop_back();
+    }
+
+    auto& slots = m_islandSlots[island];
+    for (size_t k = 0; k < count; ++k) {
+        uint32_t i = indices[k];
+        m_sleepIslands[i] = island;
+        m_linearVels[i] = Vec2{0, 0};
+        m_angularVels[i] = 0;
+        slots.push_back(m_indexToSlot[i]);
+    }
+}
+
+Body::Body(BodyStorage& storage, uint32_t index)
+    : m_storage{&storage}, m_index{index} {}
+
+void Body::SetDensity(float density) const {
+    ShapeHandle shape = GetShape();
+    float mass = shape ? density * m_storage->GetShapes().GetArea(shape) : 0;
+    float inertia =
+        shape ? density * m_storage->GetShapes().GetInertia(shape) : 0;
+    InvMass() = mass > 0 ? 1 / mass : 0;
+    InvInertia() = mass > 0 && inertia > 0 ? 1 / inertia : 0;
+}
 
 Vec2 Body::GetCenterOfMassWorldSpace() const {
-    RETURN_DEFAULT_IF_FALSE(m_shape);
-    return CreateRotation2D(m_rotation) * m_shape->GetCenterOfMass() +
-           m_position;
+    return m_storage->GetCenterOfMass(m_index);
 }
 
 Vec2 Body::GetCenterOfMassLocalSpace() const {
-    RETURN_DEFAULT_IF_FALSE(m_shape);
-    return m_shape->GetCenterOfMass();
+    return m_storage->m_localCenters[m_index];
 }
 
 Vec2 Body::BodySpace2WorldSpace(const Vec2& p) const {
-    return CreateRotation2D(m_rotation) * p + m_position;
+    return GetTransform().Apply(p);
 }
 
 Vec2 Body::WorldSpace2BodySpace(const Vec2& p) const {
-    return CreateRotation2D(-m_rotation) * (p - m_position);
+    return GetTransform().ApplyInverse(p);
+}
+
+AABB Body::GetBounds() const {
+    return m_storage->GetBounds(m_index);
 }
 
-void Body::ApplyLinearImpulse(const Vec2& impulse) {
-    RETURN_IF_FALSE(m_invMass != 0);
+void Body::ApplyLinearImpulse(const Vec2& impulse) const {
+    RETURN_IF_FALSE(InvMass() != 0);
 
-    m_linearVel += impulse * m_invMass; 
-}
\ No newline at end of file
+    WakeUp();
+    LinearVel() += impulse * InvMass();
+}
+
+void Body::ApplyImpulseAtPoint(const Vec2& impulse, const Vec2& point) const {
+    RETURN_IF_FALSE(InvMass() != 0);
+
+    WakeUp();
+    LinearVel() += impulse * InvMass();
+    AngularVel() +=
+        InvInertia() * Cross(point - GetCenterOfMassWorldSpace(), impulse);
+}
@@ -1,44 +1,231 @@
 #pragma once
+#include "aabb.hpp"
 #include "math/math.hpp"
-#include <memory>
+#include "shape.hpp"
+#include "transform.hpp"
+#include <cstdint>
+#include <vector>
 
-class Shape {
-public:
-    enum class ShapeType {
-        Sphere
-    };
+/**
+ * @brief stable reference to a body, a destroyed body's handle goes stale
+ * because its slot generation changes
+ */
+struct BodyHandle {
+    static constexpr uint32_t InvalidIndex = UINT32_MAX;
 
-    virtual ShapeType getShapeType() = 0;
-    Vec2 GetCenterOfMass() const;
+    uint32_t m_index = InvalidIndex;
+    uint32_t m_generation = 0;
 
-private:
-    Vec2 m_centerOfMass;
+    bool operator==(const BodyHandle& o) const {
+        return m_index == o.m_index && m_generation == o.m_generation;
+    }
+
+    bool operator!=(const BodyHandle& o) const { return !(*this == o); }
 };
 
-class ShapeSphere : public Shape {
+/**
+ * @brief structure of arrays storage of all bodies in a scene, index i of
+ * every array belongs to the same body
+ * @note arrays are kept dense, removing a body moves the last one into its
+ * place. Handles go through a slot map so they survive that move
+ */
+class BodyStorage {
 public:
-    ShapeSphere(float radius);
+    explicit BodyStorage(const ShapeStorage& shapes);
 
-    float m_radius;
-};
+    std::vector<Vec2> m_positions;
+    std::vector<Vec2> m_prevPositions;  // before the last fixed step
+    std::vector<Vec2> m_linearVels;  // of the center of mass
+    std::vector<float> m_angularVels;
+    std::vector<float> m_invMasses;
+    std::vector<float> m_invInertias;
+    std::vector<float> m_rotations;
+    std::vector<float> m_prevRotations;
+    // cos/sin of m_rotations, rebuilt only when they change
+    std::vector<Rotation2D> m_cosSins;
+    std::vector<Vec2> m_localCenters;  // center of mass in body space
+    std::vector<float> m_elasticities;
+    std::vector<float> m_frictions;  // Coulomb coefficient
+    std::vector<ShapeHandle> m_shapes;
+    std::vector<float> m_sleepTimes;  // how long the body has been slow
+    std::vector<uint8_t> m_bullets;   // swept against tunneling if set
+
+    BodyHandle Add(ShapeHandle shape);
+    bool Remove(BodyHandle handle);
+    void Reserve(size_t count);
+
+    size_t Size() const { return m_positions.size(); }
+
+    bool IsValid(BodyHandle handle) const;
+
+    // return BodyHandle::InvalidIndex for stale handles
+    uint32_t GetIndex(BodyHandle handle) const;
+    BodyHandle GetHandle(uint32_t index) const;
+
+    // slot is the stable part of a handle, used as broadphase id
+    uint32_t GetSlot(uint32_t index) const { return m_indexToSlot[index]; }
+
+    uint32_t GetIndexOfSlot(uint32_t slot) const { return m_slots[slot]; }
+
+    AABB GetBounds(uint32_t index) const;
+
+    Transform2D GetTransform(uint32_t index) const {
+        return {m_positions[index], m_cosSins[index]};
+    }
 
-using ShapePtr = std::shared_ptr<Shape>;
+    Vec2 GetCenterOfMass(uint32_t index) const {
+        return GetTransform(index).Apply(m_localCenters[index]);
+    }
 
+    void SetRotation(uint32_t index, float rotation);
+
+    /**
+     * @brief move and turn the body by its velocities, it turns around its
+     * center of mass
+     * @return true if the rotation changed, which costs a cos/sin pair
+     */
+    bool Integrate(uint32_t index, float delta_time);
+
+    const ShapeStorage& GetShapes() const { return *m_shapeStorage; }
+
+    bool IsAwake(uint32_t index) const {
+        return m_sleepIslands[index] == BodyHandle::InvalidIndex;
+    }
+
+    /**
+     * @brief wake the body and every body that fell asleep together with it
+     */
+    void WakeUp(uint32_t index);
+
+    /**
+     * @brief put bodies to sleep as one island, they stop moving until one
+     * of them is woken up
+     */
+    void PutToSleep(const uint32_t* indices, size_t count);
+
+private:
+    const ShapeStorage* m_shapeStorage;
+    std::vector<uint32_t> m_slots;  // slot -> index, next free slot if free
+    std::vector<uint32_t> m_generations;
+    std::vector<uint32_t> m_indexToSlot;
+    uint32_t m_freeSlot = BodyHandle::InvalidIndex;
+
+    // index -> sleeping island, InvalidIndex if awake
+    std::vector<uint32_t> m_sleepIslands;
+    std::vector<std::vector<uint32_t>> m_islandSlots;
+    std::vector<uint32_t> m_freeIslands;
+};
+
+/**
+ * @brief lightweight view of one body in a BodyStorage
+ * @note only valid until a body is created or destroyed, keep a BodyHandle
+ * to refer to a body across steps
+ */
 class Body {
 public:
-    Vec2 m_position;
-    Vec2 m_linearVel;
-    Vec2 m_angularVel;
-    float m_invMass = 1.0;
-    float m_rotation = 0;
-    float m_elasticity = 0.1f;
-    ShapePtr m_shape;
+    Body() = default;
+    Body(BodyStorage& storage, uint32_t index);
+
+    Vec2& Position() const { return m_storage->m_positions[m_index]; }
+
+    /**
+     * @brief teleport the body, unlike writing Position() it's drawn there
+     * until the next step instead of interpolated from where it was
+     */
+    void SetPosition(const Vec2& position) const {
+        m_storage->m_positions[m_index] = position;
+        m_storage->m_prevPositions[m_index] = position;
+    }
+
+    /**
+     * @brief blend of the positions before and after the last fixed step,
+     * for rendering between steps
+     * @param alpha  PhysicsScene::GetInterpolationAlpha()
+     */
+    Vec2 GetInterpolatedPosition(float alpha) const {
+        const Vec2& prev = m_storage->m_prevPositions[m_index];
+        return prev + (Position() - prev) * alpha;
+    }
+
+    Vec2& LinearVel() const { return m_storage->m_linearVels[m_index]; }
+
+    float& AngularVel() const { return m_storage->m_angularVels[m_index]; }
+
+    /**
+     * @note a body with InvMass 0 is static, contacts don't turn it either
+     */
+    float& InvMass() const { return m_storage->m_invMasses[m_index]; }
+
+    // around the center of mass
+    float& InvInertia() const { return m_storage->m_invInertias[m_index]; }
+
+    /**
+     * @brief set the mass and inertia from the shape, 0 makes it static
+     * @note bodies start with mass 1 and the inertia of their shape at that
+     * mass
+     */
+    void SetDensity(float density) const;
+
+    float Rotation() const { return m_storage->m_rotations[m_index]; }
+
+    // not interpolated from the old rotation either, like SetPosition
+    void SetRotation(float rotation) const {
+        m_storage->SetRotation(m_index, rotation);
+        m_storage->m_prevRotations[m_index] = rotation;
+    }
+
+    float GetInterpolatedRotation(float alpha) const {
+        float prev = m_storage->m_prevRotations[m_index];
+        return prev + (Rotation() - prev) * alpha;
+    }
+
+    float& Elasticity() const { return m_storage->m_elasticities[m_index]; }
+
+    /**
+     * @brief Coulomb friction coefficient, a contact uses the geometric mean
+     * of both bodies'
+     */
+    float& Friction() const { return m_storage->m_frictions[m_index]; }
+
+    ShapeHandle GetShape() const { return m_storage->m_shapes[m_index]; }
+
+    bool IsAwake() const { return m_storage->IsAwake(m_index); }
+
+    /**
+     * @brief fast bodies marked as bullet are swept through the step so they
+     * don't tunnel through thin bodies, bullets don't sweep against bullets
+     */
+    void SetBullet(bool bullet) const {
+        m_storage->m_bullets[m_index] = bullet;
+    }
+
+    bool IsBullet() const { return m_storage->m_bullets[m_index]; }
+
+    void WakeUp() const { m_storage->WakeUp(m_index); }
+
+    uint32_t GetIndex() const { return m_index; }
+
+    Transform2D GetTransform() const {
+        return m_storage->GetTransform(m_index);
+    }
 
     Vec2 GetCenterOfMassWorldSpace() const;
     Vec2 GetCenterOfMassLocalSpace() const;
     Vec2 BodySpace2WorldSpace(const Vec2& p) const;
     Vec2 WorldSpace2BodySpace(const Vec2& p) const;
-    void ApplyLinearImpulse(const Vec2& impulse);
-};
+    AABB GetBounds() const;
+    // wakes the body up
+    void ApplyLinearImpulse(const Vec2& impulse) const;
+
+    /**
+     * @brief push at a world space point, off the center of mass it also
+     * turns the body. Wakes the body up
+     */
+    void ApplyImpulseAtPoint(const Vec2& impulse, const Vec2& point) const;
+
+    explicit operator bool() const { return m_storage; }
 
-using BodyPtr = std::shared_ptr<Body>;
+private:
+    BodyStorage* m_storage = nullptr;
+    uint32_t m_index = 0;
+};
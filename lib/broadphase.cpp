@@ -0,0 +1,694 @@
+#include "broadphase.hpp"
+
+#include "macro.hpp"
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+// cells per job when FindPairs runs on several threads
+constexpr uint32_t CellGrainSize = 256;
+
+int32_t CellCoord(float value, float invCellSize) {
+    return static_cast<int32_t>(std::floor(value * invCellSize));
+}
+
+uint64_t CellKey(int32_t x, int32_t y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+           static_cast<uint32_t>(y);
+}
+
+/**
+ * @brief nodes left to visit in a depth first walk of the AABB tree, it
+ * holds at most height + 1 of them and balancing keeps the height near
+ * 1.44 * log2(leaves), far below the capacity
+ */
+class NodeStack {
+public:
+    explicit NodeStack(int32_t root) { Push(root); }
+
+    void Push(int32_t node) {
+        assert(m_count < Capacity);
+        m_nodes[m_count++] = node;
+    }
+
+    int32_t Pop() { return m_nodes[--m_count]; }
+
+    bool IsEmpty() const { return m_count == 0; }
+
+private:
+    static constexpr uint32_t Capacity = 256;
+
+    int32_t m_nodes[Capacity];
+    uint32_t m_count = 0;
+};
+
+void QueryBounds(const std::vector<AABB>& bounds, const AABB& query,
+                 const Broadphase::QueryCallback& callback) {
+    for (uint32_t id = 0; id < bounds.size(); id++) {
+        CONTINUE_IF_FALSE(bounds[id].IsIntersect(query));
+        RETURN_IF_FALSE(callback(id));
+    }
+}
+
+void RayCastBounds(const std::vector<AABB>& bounds, const Vec2& from,
+                   const Vec2& to,
+                   const Broadphase::RayCastCallback& callback) {
+    float maxFraction = 1;
+    for (uint32_t id = 0; id < bounds.size(); id++) {
+        float fraction = maxFraction;
+        CONTINUE_IF_FALSE(bounds[id].RayCast(from, to, fraction));
+        maxFraction = std::min(maxFraction, callback(id, maxFraction));
+        RETURN_IF_FALSE(maxFraction > 0);
+    }
+}
+
+}  // namespace
+
+// BruteForceBroadphase
+
+void BruteForceBroadphase::Insert(uint32_t id, const AABB& bounds) {
+    if (id >= m_bounds.size()) {
+        m_bounds.resize(id + 1, AABB::Empty());
+    }
+    m_bounds[id] = bounds;
+}
+
+void BruteForceBroadphase::Remove(uint32_t id) {
+    assert(id < m_bounds.size());
+    m_bounds[id] = AABB::Empty();
+}
+
+void BruteForceBroadphase::Move(uint32_t id, const AABB& bounds) {
+    assert(id < m_bounds.size());
+    m_bounds[id] = bounds;
+}
+
+void BruteForceBroadphase::FindPairs(std::vector<BroadphasePair>& pairs) {
+    m_stats = {};
+    for (uint32_t a = 0; a < m_bounds.size(); a++) {
+        for (uint32_t b = a + 1; b < m_bounds.size(); b++) {
+            m_stats.m_overlapTests++;
+            if (m_bounds[a].IsIntersect(m_bounds[b])) {
+                pairs.push_back({a, b});
+                m_stats.m_pairCount++;
+            }
+        }
+    }
+}
+
+void BruteForceBroadphase::QueryAABB(const AABB& bounds,
+                                     const QueryCallback& callback) const {
+    QueryBounds(m_bounds, bounds, callback);
+}
+
+void BruteForceBroadphase::RayCast(const Vec2& from, const Vec2& to,
+                                   const RayCastCallback& callback) const {
+    RayCastBounds(m_bounds, from, to, callback);
+}
+
+// UniformGridBroadphase
+
+UniformGridBroadphase::UniformGridBroadphase(float cellSize)
+    : m_cellSize{cellSize} {}
+
+void UniformGridBroadphase::Insert(uint32_t id, const AABB& bounds) {
+    if (id >= m_bounds.size()) {
+        m_bounds.resize(id + 1, AABB::Empty());
+    }
+    m_bounds[id] = bounds;
+}
+
+void UniformGridBroadphase::Remove(uint32_t id) {
+    assert(id < m_bounds.size());
+    m_bounds[id] = AABB::Empty();
+}
+
+void UniformGridBroadphase::Move(uint32_t id, const AABB& bounds) {
+    assert(id < m_bounds.size());
+    m_bounds[id] = bounds;
+}
+
+float UniformGridBroadphase::chooseCellSize() const {
+    if (m_cellSize > 0) {
+        return m_cellSize;
+    }
+
+    // twice the average extent keeps most bodies inside 1~4 cells
+    float sum = 0;
+    size_t count = 0;
+    for (auto& bounds : m_bounds) {
+        CONTINUE_IF(bounds.IsEmpty());
+        Vec2 extent = bounds.GetExtent();
+        sum += std::max(extent.x, extent.y);
+        count++;
+    }
+    float average = count == 0 ? 1 : sum / count;
+    return std::max(average * 2.0f, 0.001f);
+}
+
+void UniformGridBroadphase::FindPairs(std::vector<BroadphasePair>& pairs) {
+    m_stats = {};
+    size_t oldCount = pairs.size();
+    float invCellSize = 1.0f / chooseCellSize();
+
+    m_entries.clear();
+    for (uint32_t id = 0; id < m_bounds.size(); id++) {
+        auto& bounds = m_bounds[id];
+        CONTINUE_IF(bounds.IsEmpty());
+        int32_t minX = CellCoord(bounds.m_min.x, invCellSize);
+        int32_t minY = CellCoord(bounds.m_min.y, invCellSize);
+        int32_t maxX = CellCoord(bounds.m_max.x, invCellSize);
+        int32_t maxY = CellCoord(bounds.m_max.y, invCellSize);
+        for (int32_t x = minX; x <= maxX; x++) {
+            for (int32_t y = minY; y <= maxY; y++) {
+                m_entries.push_back({CellKey(x, y), id});
+            }
+        }
+    }
+
+    std::sort(m_entries.begin(), m_entries.end(),
+              [](const CellEntry& e1, const CellEntry& e2) {
+                  return e1.m_cell < e2.m_cell ||
+                         (e1.m_cell == e2.m_cell && e1.m_id < e2.m_id);
+              });
+
+    m_cellStarts.clear();
+    for (uint32_t i = 0; i < m_entries.size(); i++) {
+        if (i == 0 || m_entries[i].m_cell != m_entries[i - 1].m_cell) {
+            m_cellStarts.push_back(i);
+        }
+    }
+    uint32_t cellCount = static_cast<uint32_t>(m_cellStarts.size());
+    m_cellStarts.push_back(static_cast<uint32_t>(m_entries.size()));
+
+    if (!m_jobSystem || m_jobSystem->GetThreadCount() == 1) {
+        m_stats.m_overlapTests =
+            findPairsInCells(0, cellCount, invCellSize, pairs);
+    } else {
+        // chunks are concatenated in order, same pairs as the serial path
+        uint32_t chunkCount = (cellCount + CellGrainSize - 1) / CellGrainSize;
+        m_chunkPairs.resize(chunkCount);
+        m_chunkTests.resize(chunkCount);
+        m_jobSystem->ParallelFor(
+            cellCount, CellGrainSize,
+            [&](uint32_t begin, uint32_t end, uint32_t) {
+                uint32_t chunk = begin / CellGrainSize;
+                m_chunkPairs[chunk].clear();
+                m_chunkTests[chunk] = findPairsInCells(
+                    begin, end, invCellSize, m_chunkPairs[chunk]);
+            });
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+            pairs.insert(pairs.end(), m_chunkPairs[chunk].begin(),
+                         m_chunkPairs[chunk].end());
+            m_stats.m_overlapTests += m_chunkTests[chunk];
+        }
+    }
+    m_stats.m_pairCount = pairs.size() - oldCount;
+}
+
+size_t UniformGridBroadphase::findPairsInCells(
+    uint32_t begin, uint32_t end, float invCellSize,
+    std::vector<BroadphasePair>& pairs) const {
+    size_t tests = 0;
+    for (uint32_t cell = begin; cell < end; cell++) {
+        uint32_t first = m_cellStarts[cell];
+        uint32_t last = m_cellStarts[cell + 1];
+        uint64_t key = m_entries[first].m_cell;
+
+        for (uint32_t i = first; i < last; i++) {
+            for (uint32_t j = i + 1; j < last; j++) {
+                uint32_t a = m_entries[i].m_id;
+                uint32_t b = m_entries[j].m_id;
+                auto& boundsA = m_bounds[a];
+                auto& boundsB = m_bounds[b];
+                tests++;
+                CONTINUE_IF_FALSE(boundsA.IsIntersect(boundsB));
+
+                // a pair shares several cells when both bodies span them,
+                // only report it in the cell holding the overlap's min corner
+                float x = std::max(boundsA.m_min.x, boundsB.m_min.x);
+                float y = std::max(boundsA.m_min.y, boundsB.m_min.y);
+                CONTINUE_IF(CellKey(CellCoord(x, invCellSize),
+                                    CellCoord(y, invCellSize)) != key);
+
+                pairs.push_back({a, b});
+            }
+        }
+    }
+    return tests;
+}
+
+void UniformGridBroadphase::QueryAABB(const AABB& bounds,
+                                      const QueryCallback& callback) const {
+    // cells are rebuilt from scratch in FindPairs, so they are stale for
+    // bodies inserted afterwards, scan the bounds directly instead
+    QueryBounds(m_bounds, bounds, callback);
+}
+
+void UniformGridBroadphase::RayCast(const Vec2& from, const Vec2& to,
+                                    const RayCastCallback& callback) const {
+    RayCastBounds(m_bounds, from, to, callback);
+}
+
+// AABBTreeBroadphase
+
+AABBTreeBroadphase::AABBTreeBroadphase(float margin) : m_margin{margin} {}
+
+int32_t AABBTreeBroadphase::allocateNode() {
+    if (m_freeList == NullNode) {
+        m_nodes.emplace_back();
+        return static_cast<int32_t>(m_nodes.size() - 1);
+    }
+
+    int32_t node = m_freeList;
+    m_freeList = m_nodes[node].m_parent;
+    m_nodes[node] = Node{};
+    return node;
+}
+
+void AABBTreeBroadphase::freeNode(int32_t node) {
+    m_nodes[node].m_parent = m_freeList;
+    m_nodes[node].m_height = -1;
+    m_freeList = node;
+}
+
+void AABBTreeBroadphase::Insert(uint32_t id, const AABB& bounds) {
+    if (id >= m_leaves.size()) {
+        m_leaves.resize(id + 1, NullNode);
+    }
+    assert(m_leaves[id] == NullNode);
+
+    int32_t leaf = allocateNode();
+    Vec2 margin{m_margin};
+    m_nodes[leaf].m_bounds = {bounds.m_min - margin, bounds.m_max + margin};
+    m_nodes[leaf].m_id = id;
+    m_leaves[id] = leaf;
+    insertLeaf(leaf);
+    markMoved(id);
+}
+
+void AABBTreeBroadphase::Remove(uint32_t id) {
+    assert(id < m_leaves.size() && m_leaves[id] != NullNode);
+    int32_t leaf = m_leaves[id];
+    removeLeaf(leaf);
+    freeNode(leaf);
+    m_leaves[id] = NullNode;
+
+    if (id < m_isMoved.size() && m_isMoved[id]) {
+        m_isMoved[id] = false;
+        std::erase(m_moved, id);
+    }
+    std::erase_if(m_pairs, [=](const BroadphasePair& pair) {
+        return pair.m_a == id || pair.m_b == id;
+    });
+}
+
+void AABBTreeBroadphase::Move(uint32_t id, const AABB& bounds) {
+    assert(id < m_leaves.size() && m_leaves[id] != NullNode);
+    int32_t leaf = m_leaves[id];
+    RETURN_IF_FALSE(!m_nodes[leaf].m_bounds.Contains(bounds));
+
+    removeLeaf(leaf);
+    Vec2 margin{m_margin};
+    m_nodes[leaf].m_bounds = {bounds.m_min - margin, bounds.m_max + margin};
+    insertLeaf(leaf);
+    markMoved(id);
+}
+
+void AABBTreeBroadphase::markMoved(uint32_t id) {
+    if (id >= m_isMoved.size()) {
+        m_isMoved.resize(id + 1, false);
+    }
+    if (!m_isMoved[id]) {
+        m_isMoved[id] = true;
+        m_moved.push_back(id);
+    }
+}
+
+void AABBTreeBroadphase::insertLeaf(int32_t leaf) {
+    if (m_root == NullNode) {
+        m_root = leaf;
+        m_nodes[leaf].m_parent = NullNode;
+        return;
+    }
+
+    // find the best sibling by the surface area heuristic
+    AABB leafBounds = m_nodes[leaf].m_bounds;
+    int32_t index = m_root;
+    while (!m_nodes[index].IsLeaf()) {
+        const Node& node = m_nodes[index];
+        float area = node.m_bounds.GetPerimeter();
+        float combinedArea =
+            AABB::Merge(node.m_bounds, leafBounds).GetPerimeter();
+
+        // cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedArea;
+        // minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int32_t child) {
+            const Node& childNode = m_nodes[child];
+            float merged =
+                AABB::Merge(leafBounds, childNode.m_bounds).GetPerimeter();
+            if (childNode.IsLeaf()) {
+                return merged + inheritanceCost;
+            }
+            return merged - childNode.m_bounds.GetPerimeter() +
+                   inheritanceCost;
+        };
+
+        float cost1 = descendCost(node.m_child1);
+        float cost2 = descendCost(node.m_child2);
+        BREAK_IF_FALSE(cost >= cost1 || cost >= cost2);
+
+        index = cost1 < cost2 ? node.m_child1 : node.m_child2;
+    }
+
+    int32_t sibling = index;
+    int32_t oldParent = m_nodes[sibling].m_parent;
+    int32_t newParent = allocateNode();
+    m_nodes[newParent].m_parent = oldParent;
+    m_nodes[newParent].m_bounds =
+        AABB::Merge(leafBounds, m_nodes[sibling].m_bounds);
+    m_nodes[newParent].m_height = m_nodes[sibling].m_height + 1;
+    m_nodes[newParent].m_child1 = sibling;
+    m_nodes[newParent].m_child2 = leaf;
+    m_nodes[sibling].m_parent = newParent;
+    m_nodes[leaf].m_parent = newParent;
+
+    if (oldParent == NullNode) {
+        m_root = newParent;
+    } else if (m_nodes[oldParent].m_child1 == sibling) {
+        m_nodes[oldParent].m_child1 = newParent;
+    } else {
+        m_nodes[oldParent].m_child2 = newParent;
+    }
+
+    refit(m_nodes[leaf].m_parent);
+}
+
+void AABBTreeBroadphase::removeLeaf(int32_t leaf) {
+    if (leaf == m_root) {
+        m_root = NullNode;
+        return;
+    }
+
+    int32_t parent = m_nodes[leaf].m_parent;
+    int32_t grandParent = m_nodes[parent].m_parent;
+    int32_t sibling = m_nodes[parent].m_child1 == leaf
+                          ? m_nodes[parent].m_child2
+                          : m_nodes[parent].m_child1;
+
+    freeNode(parent);
+    m_nodes[sibling].m_parent = grandParent;
+    if (grandParent == NullNode) {
+        m_root = sibling;
+        return;
+    }
+
+    if (m_nodes[grandParent].m_child1 == parent) {
+        m_nodes[grandParent].m_child1 = sibling;
+    } else {
+        m_nodes[grandParent].m_child2 = sibling;
+    }
+    refit(grandParent);
+}
+
+void AABBTreeBroadphase::refit(int32_t index) {
+    while (index != NullNode) {
+        index = balance(index);
+
+        Node& node = m_nodes[index];
+        const Node& child1 = m_nodes[node.m_child1];
+        const Node& child2 = m_nodes[node.m_child2];
+        node.m_height = 1 + std::max(child1.m_height, child2.m_height);
+        node.m_bounds = AABB::Merge(child1.m_bounds, child2.m_bounds);
+
+        index = node.m_parent;
+    }
+}
+
+/**
+ * @brief rotate the higher child of node up when the children heights differ
+ * by more than one
+ * @return the node now at node's position
+ */
+int32_t AABBTreeBroadphase::balance(int32_t iA) {
+    Node& a = m_nodes[iA];
+    if (a.IsLeaf() || a.m_height < 2) {
+        return iA;
+    }
+
+    int32_t iB = a.m_child1;
+    int32_t iC = a.m_child2;
+    int32_t heightDiff = m_nodes[iC].m_height - m_nodes[iB].m_height;
+    RETURN_VALUE_IF_FALSE(heightDiff > 1 || heightDiff < -1, iA);
+
+    // the higher child takes A's place, A adopts one of its children
+    bool rotateC = heightDiff > 1;
+    int32_t iUp = rotateC ? iC : iB;
+    int32_t iStay = rotateC ? iB : iC;
+    Node& up = m_nodes[iUp];
+    int32_t iF = up.m_child1;
+    int32_t iG = up.m_child2;
+
+    up.m_child1 = iA;
+    up.m_parent = a.m_parent;
+    a.m_parent = iUp;
+    if (up.m_parent == NullNode) {
+        m_root = iUp;
+    } else if (m_nodes[up.m_parent].m_child1 == iA) {
+        m_nodes[up.m_parent].m_child1 = iUp;
+    } else {
+        m_nodes[up.m_parent].m_child2 = iUp;
+    }
+
+    // the higher grandchild stays with the promoted node
+    if (m_nodes[iF].m_height < m_nodes[iG].m_height) {
+        std::swap(iF, iG);
+    }
+    up.m_child2 = iF;
+    if (rotateC) {
+        a.m_child2 = iG;
+    } else {
+        a.m_child1 = iG;
+    }
+    m_nodes[iG].m_parent = iA;
+
+    const Node& stay = m_nodes[iStay];
+    const Node& moved = m_nodes[iG];
+    a.m_bounds = AABB::Merge(stay.m_bounds, moved.m_bounds);
+    a.m_height = 1 + std::max(stay.m_height, moved.m_height);
+    up.m_bounds = AABB::Merge(a.m_bounds, m_nodes[iF].m_bounds);
+    up.m_height = 1 + std::max(a.m_height, m_nodes[iF].m_height);
+
+    return iUp;
+}
+
+template <typename F>
+size_t AABBTreeBroadphase::query(const AABB& bounds, F&& f) const {
+    size_t tests = 0;
+    RETURN_VALUE_IF_FALSE(m_root != NullNode, tests);
+
+    NodeStack stack{m_root};
+    while (!stack.IsEmpty()) {
+        const Node& node = m_nodes[stack.Pop()];
+        tests++;
+        CONTINUE_IF_FALSE(node.m_bounds.IsIntersect(bounds));
+
+        if (node.IsLeaf()) {
+            RETURN_VALUE_IF_FALSE(f(node.m_id), tests);
+        } else {
+            stack.Push(node.m_child1);
+            stack.Push(node.m_child2);
+        }
+    }
+    return tests;
+}
+
+void AABBTreeBroadphase::FindPairs(std::vector<BroadphasePair>& pairs) {
+    auto pairLess = [](const BroadphasePair& p1, const BroadphasePair& p2) {
+        return p1.m_a < p2.m_a || (p1.m_a == p2.m_a && p1.m_b < p2.m_b);
+    };
+
+    m_stats = {};
+
+    // fat bounds of leaves that were not reinserted are unchanged, so only
+    // pairs touching a moved leaf need to be rebuilt
+    if (!m_moved.empty()) {
+        std::erase_if(m_pairs, [&](const BroadphasePair& pair) {
+            return m_isMoved[pair.m_a] ||
+                   (pair.m_b < m_isMoved.size() && m_isMoved[pair.m_b]);
+        });
+
+        m_newPairs.clear();
+        for (uint32_t id : m_moved) {
+            auto& bounds = m_nodes[m_leaves[id]].m_bounds;
+            auto& tests = m_stats.m_overlapTests;
+            tests += query(bounds, [&](uint32_t other) {
+                RETURN_TRUE_IF_FALSE(other != id);
+                // a pair of two moved leaves is found from both of them
+                bool otherMoved = other < m_isMoved.size() && m_isMoved[other];
+                if (!otherMoved || other > id) {
+                    m_newPairs.push_back(
+                        {std::min(id, other), std::max(id, other)});
+                }
+                return true;
+            });
+        }
+        for (uint32_t id : m_moved) {
+            m_isMoved[id] = false;
+        }
+        m_moved.clear();
+
+        std::sort(m_newPairs.begin(), m_newPairs.end(), pairLess);
+        size_t oldCount = m_pairs.size();
+        m_pairs.insert(m_pairs.end(), m_newPairs.begin(), m_newPairs.end());
+        std::inplace_merge(m_pairs.begin(), m_pairs.begin() + oldCount,
+                           m_pairs.end(), pairLess);
+    }
+
+    pairs.insert(pairs.end(), m_pairs.begin(), m_pairs.end());
+    m_stats.m_pairCount = m_pairs.size();
+}
+
+void AABBTreeBroadphase::QueryAABB(const AABB& bounds,
+                                   const QueryCallback& callback) const {
+    query(bounds, callback);
+}
+
+void AABBTreeBroadphase::RayCast(const Vec2& from, const Vec2& to,
+                                 const RayCastCallback& callback) const {
+    RETURN_IF_FALSE(m_root != NullNode);
+
+    float maxFraction = 1;
+    NodeStack stack{m_root};
+    while (!stack.IsEmpty()) {
+        const Node& node = m_nodes[stack.Pop()];
+
+        float fraction = maxFraction;
+        CONTINUE_IF_FALSE(node.m_bounds.RayCast(from, to, fraction));
+
+        if (node.IsLeaf()) {
+            maxFraction =
+                std::min(maxFraction, callback(node.m_id, maxFraction));
+            RETURN_IF_FALSE(maxFraction > 0);
+        } else {
+            stack.Push(node.m_child1);
+            stack.Push(node.m_child2);
+        }
+    }
+}
+
+const AABB& AABBTreeBroadphase::GetFatBounds(uint32_t id) const {
+    assert(id < m_leaves.size() && m_leaves[id] != NullNode);
+    return m_nodes[m_leaves[id]].m_bounds;
+}
+
+int32_t AABBTreeBroadphase::GetHeight() const {
+    return m_root == NullNode ? 0 : m_nodes[m_root].m_height;
+}
+
+// SweepAndPruneBroadphase
+
+void SweepAndPruneBroadphase::Insert(uint32_t id, const AABB& bounds) {
+    if (id >= m_bounds.size()) {
+        m_bounds.resize(id + 1, AABB::Empty());
+        m_activeIndex.resize(id + 1);
+    }
+    m_bounds[id] = bounds;
+
+    for (Endpoint endpoint : {Endpoint{bounds.m_min.x, id, false},
+                              Endpoint{bounds.m_max.x, id, true}}) {
+        m_endpoints.insert(std::upper_bound(m_endpoints.begin(),
+                                            m_endpoints.end(), endpoint),
+                           endpoint);
+    }
+}
+
+void SweepAndPruneBroadphase::Remove(uint32_t id) {
+    assert(id < m_bounds.size());
+    m_bounds[id] = AABB::Empty();
+    std::erase_if(m_endpoints, [=](const Endpoint& endpoint) {
+        return endpoint.m_id == id;
+    });
+}
+
+void SweepAndPruneBroadphase::Move(uint32_t id, const AABB& bounds) {
+    assert(id < m_bounds.size());
+    m_bounds[id] = bounds;
+}
+
+void SweepAndPruneBroadphase::FindPairs(std::vector<BroadphasePair>& pairs) {
+    m_stats = {};
+    size_t oldCount = pairs.size();
+
+    for (auto& endpoint : m_endpoints) {
+        auto& bounds = m_bounds[endpoint.m_id];
+        endpoint.m_value = endpoint.m_isMax ? bounds.m_max.x : bounds.m_min.x;
+    }
+
+    // insertion sort, nearly linear since the order barely changes
+    for (size_t i = 1; i < m_endpoints.size(); i++) {
+        Endpoint endpoint = m_endpoints[i];
+        size_t j = i;
+        while (j > 0 && endpoint < m_endpoints[j - 1]) {
+            m_endpoints[j] = m_endpoints[j - 1];
+            j--;
+        }
+        m_endpoints[j] = endpoint;
+        m_stats.m_sortSwaps += i - j;
+    }
+
+    m_active.clear();
+    for (auto& endpoint : m_endpoints) {
+        uint32_t id = endpoint.m_id;
+        if (endpoint.m_isMax) {
+            uint32_t index = m_activeIndex[id];
+            m_activeIndex[m_active.back()] = index;
+            m_active[index] = m_active.back();
+            m_active.pop_back();
+            continue;
+        }
+
+        // every active interval overlaps on x, only y is left to check
+        auto& bounds = m_bounds[id];
+        for (uint32_t other : m_active) {
+            auto& otherBounds = m_bounds[other];
+            m_stats.m_overlapTests++;
+            CONTINUE_IF(bounds.m_min.y > otherBounds.m_max.y ||
+                        bounds.m_max.y < otherBounds.m_min.y);
+            pairs.push_back({std::min(id, other), std::max(id, other)});
+        }
+        m_activeIndex[id] = static_cast<uint32_t>(m_active.size());
+        m_active.push_back(id);
+    }
+
+    m_stats.m_pairCount = pairs.size() - oldCount;
+}
+
+void SweepAndPruneBroadphase::QueryAABB(const AABB& bounds,
+                                        const QueryCallback& callback) const {
+    // endpoints are only sorted during FindPairs, so they may be stale here
+    QueryBounds(m_bounds, bounds, callback);
+}
+
+void SweepAndPruneBroadphase::RayCast(const Vec2& from, const Vec2& to,
+                                      const RayCastCallback& callback) const {
+    RayCastBounds(m_bounds, from, to, callback);
+}
+
+BroadphasePtr CreateBroadphase(BroadphaseType type) {
+    switch (type) {
+        case BroadphaseType::BruteForce:
+            return std::make_unique<BruteForceBroadphase>();
+        case BroadphaseType::UniformGrid:
+            return std::make_unique<UniformGridBroadphase>();
+        case BroadphaseType::AABBTree:
+            return std::make_unique<AABBTreeBroadphase>();
+        case BroadphaseType::SweepAndPrune:
+            return std::make_unique<SweepAndPruneBroadphase>();
+    }
+    return nullptr;
+}
@@ -0,0 +1,230 @@
+#pragma once
+#include "aabb.hpp"
+#include "job_system.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct BroadphasePair {
+    uint32_t m_a;
+    uint32_t m_b;
+};
+
+enum class BroadphaseType {
+    BruteForce,
+    UniformGrid,
+    AABBTree,
+    SweepAndPrune,
+};
+
+/**
+ * @brief per step counters, reset by every FindPairs
+ */
+struct BroadphaseStats {
+    size_t m_pairCount = 0;
+    size_t m_overlapTests = 0;
+    size_t m_sortSwaps = 0;
+};
+
+class Broadphase {
+public:
+    // return false to stop the query
+    using QueryCallback = std::function<bool(uint32_t id)>;
+
+    // return the new max fraction of the ray: 0 stops the cast, the passed in
+    // fraction leaves it unchanged
+    using RayCastCallback = std::function<float(uint32_t id, float fraction)>;
+
+    virtual ~Broadphase() = default;
+
+    virtual void Insert(uint32_t id, const AABB& bounds) = 0;
+    virtual void Remove(uint32_t id) = 0;
+    virtual void Move(uint32_t id, const AABB& bounds) = 0;
+    virtual void FindPairs(std::vector<BroadphasePair>& pairs) = 0;
+
+    virtual void QueryAABB(const AABB& bounds,
+                           const QueryCallback& callback) const = 0;
+    virtual void RayCast(const Vec2& from, const Vec2& to,
+                         const RayCastCallback& callback) const = 0;
+
+    const BroadphaseStats& GetStats() const { return m_stats; }
+
+    /**
+     * @brief let FindPairs spread its work over threads, pairs come out in
+     * the same order either way. Null runs serially
+     */
+    void SetJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+protected:
+    BroadphaseStats m_stats;
+    JobSystem* m_jobSystem = nullptr;
+};
+
+using BroadphasePtr = std::unique_ptr<Broadphase>;
+
+BroadphasePtr CreateBroadphase(BroadphaseType type);
+
+/**
+ * @brief tests every pair of bodies, only useful as a reference
+ */
+class BruteForceBroadphase : public Broadphase {
+public:
+    void Insert(uint32_t id, const AABB& bounds) override;
+    void Remove(uint32_t id) override;
+    void Move(uint32_t id, const AABB& bounds) override;
+    void FindPairs(std::vector<BroadphasePair>& pairs) override;
+
+    void QueryAABB(const AABB& bounds,
+                   const QueryCallback& callback) const override;
+    void RayCast(const Vec2& from, const Vec2& to,
+                 const RayCastCallback& callback) const override;
+
+private:
+    std::vector<AABB> m_bounds;
+};
+
+/**
+ * @brief uniform grid broadphase, bodies are bucketed by the cells their AABB
+ * covers and only bodies sharing a cell are reported as candidate pairs
+ */
+class UniformGridBroadphase : public Broadphase {
+public:
+    /**
+     * @param cellSize  side length of one cell, <= 0 means choose it from the
+     * average AABB size every step
+     */
+    explicit UniformGridBroadphase(float cellSize = 0);
+
+    void Insert(uint32_t id, const AABB& bounds) override;
+    void Remove(uint32_t id) override;
+    void Move(uint32_t id, const AABB& bounds) override;
+    void FindPairs(std::vector<BroadphasePair>& pairs) override;
+
+    void QueryAABB(const AABB& bounds,
+                   const QueryCallback& callback) const override;
+    void RayCast(const Vec2& from, const Vec2& to,
+                 const RayCastCallback& callback) const override;
+
+    void SetCellSize(float cellSize) { m_cellSize = cellSize; }
+
+    float GetCellSize() const { return m_cellSize; }
+
+private:
+    struct CellEntry {
+        uint64_t m_cell;
+        uint32_t m_id;
+    };
+
+    float m_cellSize;
+    std::vector<AABB> m_bounds;
+    std::vector<CellEntry> m_entries;
+    std::vector<uint32_t> m_cellStarts;  // first entry of each cell
+    std::vector<std::vector<BroadphasePair>> m_chunkPairs;
+    std::vector<size_t> m_chunkTests;
+
+    float chooseCellSize() const;
+
+    // return count of overlap tests
+    size_t findPairsInCells(uint32_t begin, uint32_t end, float invCellSize,
+                            std::vector<BroadphasePair>& pairs) const;
+};
+
+/**
+ * @brief dynamic bounding volume tree, leaves store fat AABBs so a body only
+ * gets reinserted after it leaves its fat box
+ * @note pairs are overlaps of fat AABBs and are kept between steps, only
+ * reinserted leaves query the tree again
+ */
+class AABBTreeBroadphase : public Broadphase {
+public:
+    /**
+     * @param margin  how far a leaf AABB is enlarged on each side
+     */
+    explicit AABBTreeBroadphase(float margin = 4.0f);
+
+    void Insert(uint32_t id, const AABB& bounds) override;
+    void Remove(uint32_t id) override;
+    void Move(uint32_t id, const AABB& bounds) override;
+    void FindPairs(std::vector<BroadphasePair>& pairs) override;
+
+    void QueryAABB(const AABB& bounds,
+                   const QueryCallback& callback) const override;
+    void RayCast(const Vec2& from, const Vec2& to,
+                 const RayCastCallback& callback) const override;
+
+    const AABB& GetFatBounds(uint32_t id) const;
+    int32_t GetHeight() const;
+
+private:
+    static constexpr int32_t NullNode = -1;
+
+    struct Node {
+        AABB m_bounds;
+        int32_t m_parent = NullNode;  // next free node when in free list
+        int32_t m_child1 = NullNode;
+        int32_t m_child2 = NullNode;
+        int32_t m_height = 0;         // leaf = 0, free node = -1
+        uint32_t m_id = 0;
+
+        bool IsLeaf() const { return m_child1 == NullNode; }
+    };
+
+    float m_margin;
+    int32_t m_root = NullNode;
+    int32_t m_freeList = NullNode;
+    std::vector<Node> m_nodes;
+    std::vector<int32_t> m_leaves;  // id -> leaf node
+    std::vector<uint32_t> m_moved;
+    std::vector<bool> m_isMoved;
+    std::vector<BroadphasePair> m_pairs;      // sorted
+    std::vector<BroadphasePair> m_newPairs;
+
+    int32_t allocateNode();
+    void freeNode(int32_t node);
+    void insertLeaf(int32_t leaf);
+    void removeLeaf(int32_t leaf);
+    int32_t balance(int32_t node);
+    void refit(int32_t node);
+    void markMoved(uint32_t id);
+
+    // return count of tested nodes
+    template <typename F>
+    size_t query(const AABB& bounds, F&& f) const;
+};
+
+/**
+ * @brief sort and sweep on the x axis
+ * @note endpoints are kept sorted between steps, bodies move little per step
+ * so the insertion sort only does a few swaps
+ */
+class SweepAndPruneBroadphase : public Broadphase {
+public:
+    void Insert(uint32_t id, const AABB& bounds) override;
+    void Remove(uint32_t id) override;
+    void Move(uint32_t id, const AABB& bounds) override;
+    void FindPairs(std::vector<BroadphasePair>& pairs) override;
+
+    void QueryAABB(const AABB& bounds,
+                   const QueryCallback& callback) const override;
+    void RayCast(const Vec2& from, const Vec2& to,
+                 const RayCastCallback& callback) const override;
+
+private:
+    struct Endpoint {
+        float m_value;
+        uint32_t m_id;
+        bool m_isMax;
+
+        // min endpoints go first on ties so touching boxes overlap
+        bool operator<(const Endpoint& o) const {
+            return m_value < o.m_value ||
+                   (m_value == o.m_value && !m_isMax && o.m_isMax);
+        }
+    };
+
+    std::vector<AABB> m_bounds;
+    std::vector<Endpoint> m_endpoints;
+    std::vector<uint32_t> m_active;
+    std::vector<uint32_t> m_activeIndex;  // id -> index in m_active
+};
@@ -0,0 +1,45 @@
+#include "bvh.hpp"
+
+#include "macro.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+void BuildNodes(const AABB* bounds, uint32_t* items, uint32_t count,
+                std::vector<BVHNode>& nodes) {
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    AABB nodeBounds = AABB::Empty();
+    for (uint32_t i = 0; i < count; ++i) {
+        nodeBounds = AABB::Merge(nodeBounds, bounds[items[i]]);
+    }
+    nodes.push_back({nodeBounds, BVHNode::InvalidItem, 0});
+
+    if (count == 1) {
+        nodes[index].m_item = items[0];
+    } else {
+        Vec2 extent = nodeBounds.GetExtent();
+        bool splitX = extent.x >= extent.y;
+        uint32_t half = count / 2;
+        std::nth_element(items, items + half, items + count,
+                         [&](uint32_t a, uint32_t b) {
+                             Vec2 ca = bounds[a].m_min + bounds[a].m_max;
+                             Vec2 cb = bounds[b].m_min + bounds[b].m_max;
+                             return splitX ? ca.x < cb.x : ca.y < cb.y;
+                         });
+        BuildNodes(bounds, items, half, nodes);
+        BuildNodes(bounds, items + half, count - half, nodes);
+    }
+    nodes[index].m_next = static_cast<uint32_t>(nodes.size());
+}
+
+}  // namespace
+
+void BuildBVH(const AABB* bounds, uint32_t count, std::vector<BVHNode>& nodes) {
+    nodes.clear();
+    RETURN_IF_FALSE(count > 0);
+    std::vector<uint32_t> items(count);
+    std::iota(items.begin(), items.end(), 0u);
+    nodes.reserve(2 * count - 1);
+    BuildNodes(bounds, items.data(), count, nodes);
+}
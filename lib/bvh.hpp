@@ -0,0 +1,45 @@
+#pragma once
+#include "aabb.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief node of a bounding volume hierarchy over items that never move
+ * @note nodes are stored flat in depth first order, trivially copyable so
+ * they can be baked to a file and used in place
+ */
+struct BVHNode {
+    static constexpr uint32_t InvalidItem = UINT32_MAX;
+
+    AABB m_bounds;
+    uint32_t m_item;  // InvalidItem for inner nodes
+    uint32_t m_next;  // first node after the subtree
+};
+
+/**
+ * @brief build nodes over items with the given bounds, one item per leaf,
+ * split at the median of the centers along the longer axis
+ */
+void BuildBVH(const AABB* bounds, uint32_t count, std::vector<BVHNode>& nodes);
+
+/**
+ * @brief call f with every item whose bounds overlap bounds
+ * @note a node not overlapping skips to its m_next, so the query walks the
+ * array front to back without a stack
+ */
+template <typename F>
+void QueryBVH(const BVHNode* nodes, uint32_t count, const AABB& bounds,
+              F&& f) {
+    uint32_t i = 0;
+    while (i < count) {
+        const BVHNode& node = nodes[i];
+        if (!node.m_bounds.IsIntersect(bounds)) {
+            i = node.m_next;
+            continue;
+        }
+        if (node.m_item != BVHNode::InvalidItem) {
+            f(node.m_item);
+        }
+        i++;
+    }
+}
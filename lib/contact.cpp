@@ -1,59 +1,722 @@
 #include "contact.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cfloat>
 
 #include "../sandbox/macro.hpp"
 
-bool Intersect(BodyPtr& b1, BodyPtr& b2, Contact& contact) {
-    if (b1->m_shape->getShapeType() == Shape::ShapeType::Sphere &&
-        b2->m_shape->getShapeType() == Shape::ShapeType::Sphere) {
-        auto sphere1 = std::dynamic_pointer_cast<ShapeSphere>(b1->m_shape);
-        auto sphere2 = std::dynamic_pointer_cast<ShapeSphere>(b2->m_shape);
-        float radiusSum = sphere1->m_radius + sphere2->m_radius;
-        float distSquard = LengthSqrd(b1->m_position - b2->m_position);
-        bool intersected = distSquard <= radiusSum * radiusSum;
+namespace {
 
-        RETURN_FALSE_IF_FALSE(intersected);
+// conservative advancement stops once shapes are this close, and caps its
+// iterations for grazing sweeps that approach the touch slowly
+constexpr float TimeOfImpactTolerance = 0.01f;
+constexpr uint32_t MaxTimeOfImpactIterations = 32;
 
-        float dist = std::sqrt(distSquard);
-        float elasticity = b1->m_elasticity * b2->m_elasticity;
+// prefer the axis of A as reference face unless B's is clearly better, so
+// the manifold doesn't flip between near equal faces
+constexpr float ReferenceFaceTolerance = 0.005f;
 
-        Vec2 vab =
-            dist == 0 ? Vec2{0, 0} : (b2->m_position - b1->m_position) / dist;
-        contact.m_normal = Normalize(vab);
-        contact.m_bodyA = b1;
-        contact.m_bodyB = b2;
-        contact.m_sperateDist =
-            std::abs(dist - (sphere1->m_radius + sphere2->m_radius));
-        contact.m_ptOnAWorldSpace =
-            b1->m_position + sphere1->m_radius * contact.m_normal;
-        contact.m_ptOnBWorldSpace =
-            b2->m_position - sphere1->m_radius * contact.m_normal;
+// cores closer than this are treated as overlapping, the normal from their
+// closest points would be noise
+constexpr float CoreOverlapDistance = 1e-4f;
 
-        return intersected;
+struct CollideEntry {
+    CollideFunc m_func = nullptr;
+    bool m_swap = false;
+};
+
+constexpr size_t ShapeTypeCount =
+    static_cast<size_t>(Shape::ShapeType::Count);
+
+using CollideTable =
+    std::array<std::array<CollideEntry, ShapeTypeCount>, ShapeTypeCount>;
+
+CollideTable& GetCollideTable() {
+    static CollideTable table;
+    return table;
+}
+
+// register every shape pair here
+const bool gDefaultCollideFuncsRegistered = [] {
+    RegisterCollideFunc<ShapeSphere, ShapeSphere, CollideSphereSphere>();
+    RegisterCollideFunc<ShapePolygon, ShapePolygon, CollidePolygons>();
+    RegisterCollideFunc<ShapePolygon, ShapeSphere, CollidePolygonSphere>();
+    RegisterConvexCollideFunc<ShapeCapsule, ShapeSphere>();
+    RegisterConvexCollideFunc<ShapeCapsule, ShapePolygon>();
+    RegisterConvexCollideFunc<ShapeCapsule, ShapeCapsule>();
+    RegisterConvexCollideFunc<ShapeRoundedBox, ShapeSphere>();
+    RegisterConvexCollideFunc<ShapeRoundedBox, ShapePolygon>();
+    RegisterConvexCollideFunc<ShapeRoundedBox, ShapeCapsule>();
+    RegisterConvexCollideFunc<ShapeRoundedBox, ShapeRoundedBox>();
+    return true;
+}();
+
+void SwapContact(Contact& contact) {
+    contact.m_normal = -contact.m_normal;
+    std::swap(contact.m_ptOnAWorldSpace, contact.m_ptOnBWorldSpace);
+    std::swap(contact.m_ptOnALocalSpace, contact.m_ptOnBLocalSpace);
+}
+
+// polygon with its vertices and normals in world space
+struct WorldPolygon {
+    Vec2 m_vertices[ShapePolygon::MaxVertices];
+    Vec2 m_normals[ShapePolygon::MaxVertices];
+    uint32_t m_count;
+};
+
+WorldPolygon ToWorld(const ShapePolygon& poly, const Transform2D& transform) {
+    WorldPolygon world;
+    world.m_count = poly.m_count;
+    TransformPoints(transform, poly.m_vertices, poly.m_count,
+                    world.m_vertices);
+    RotateVectors(transform.m_rotation, poly.m_normals, poly.m_count,
+                  world.m_normals);
+    return world;
+}
+
+// distance of the deepest vertex of poly2 in front of edge of poly1
+float EdgeSeparation(const WorldPolygon& poly1, uint32_t edge,
+                     const WorldPolygon& poly2) {
+    const Vec2& n = poly1.m_normals[edge];
+    const Vec2& v1 = poly1.m_vertices[edge];
+    float separation = FLT_MAX;
+    for (uint32_t i = 0; i < poly2.m_count; ++i) {
+        separation = std::min(separation, Dot(n, poly2.m_vertices[i] - v1));
     }
-    return false;
+    return separation;
 }
 
-void ResolveContact(Contact& contact) {
-    BodyPtr& bA = contact.m_bodyA;
-    BodyPtr& bB = contact.m_bodyB;
-    
-    contact.m_bodyA->m_linearVel = Vec2{0, 0};
-    contact.m_bodyB->m_linearVel = Vec2{0, 0};
-    float elasticity = bA->m_elasticity * bB->m_elasticity;
+float MaxSeparation(const WorldPolygon& poly1, const WorldPolygon& poly2,
+                    uint32_t& edge) {
+    float maxSeparation = -FLT_MAX;
+    for (uint32_t i = 0; i < poly1.m_count; ++i) {
+        float separation = EdgeSeparation(poly1, i, poly2);
+        if (separation > maxSeparation) {
+            maxSeparation = separation;
+            edge = i;
+        }
+        // any separating axis will do
+        BREAK_IF_FALSE(separation <= 0);
+    }
+    return maxSeparation;
+}
+
+// keep the part of segment in with dot(normal, p) <= offset
+uint32_t ClipSegment(const Vec2* in, Vec2* out, const Vec2& normal,
+                     float offset) {
+    float dist0 = Dot(normal, in[0]) - offset;
+    float dist1 = Dot(normal, in[1]) - offset;
+
+    uint32_t count = 0;
+    if (dist0 <= 0) {
+        out[count++] = in[0];
+    }
+    if (dist1 <= 0) {
+        out[count++] = in[1];
+    }
+    if (dist0 * dist1 < 0) {
+        out[count++] = in[0] + (in[1] - in[0]) * (dist0 / (dist0 - dist1));
+    }
+    return count;
+}
+
+// separating axis test of polygons already in world space, a segment is a
+// polygon of two vertices
+uint32_t CollideWorldPolygons(const WorldPolygon& worldA,
+                              const WorldPolygon& worldB, CollideCache& cache,
+                              Contact* contacts) {
+    // last step's axis still separating is the common case for resting
+    // neighbours in the same broadphase cell
+    if (cache.m_axisOwner == 0 && cache.m_axisEdge < worldA.m_count) {
+        RETURN_VALUE_IF_FALSE(
+            EdgeSeparation(worldA, cache.m_axisEdge, worldB) <= 0, 0);
+    } else if (cache.m_axisOwner == 1 && cache.m_axisEdge < worldB.m_count) {
+        RETURN_VALUE_IF_FALSE(
+            EdgeSeparation(worldB, cache.m_axisEdge, worldA) <= 0, 0);
+    }
+
+    uint32_t edgeA = 0;
+    float separationA = MaxSeparation(worldA, worldB, edgeA);
+    if (separationA > 0) {
+        cache.m_axisOwner = 0;
+        cache.m_axisEdge = static_cast<uint8_t>(edgeA);
+        return 0;
+    }
+    uint32_t edgeB = 0;
+    float separationB = MaxSeparation(worldB, worldA, edgeB);
+    if (separationB > 0) {
+        cache.m_axisOwner = 1;
+        cache.m_axisEdge = static_cast<uint8_t>(edgeB);
+        return 0;
+    }
+
+    // the face of least penetration is the reference, the other polygon's
+    // most anti parallel edge is clipped against its side planes
+    bool flip = separationB > separationA + ReferenceFaceTolerance;
+    const WorldPolygon& ref = flip ? worldB : worldA;
+    const WorldPolygon& inc = flip ? worldA : worldB;
+    uint32_t refEdge = flip ? edgeB : edgeA;
+    cache.m_axisOwner = flip ? 1 : 0;
+    cache.m_axisEdge = static_cast<uint8_t>(refEdge);
+
+    const Vec2& refNormal = ref.m_normals[refEdge];
+    uint32_t incEdge = 0;
+    float minDot = FLT_MAX;
+    for (uint32_t i = 0; i < inc.m_count; ++i) {
+        float d = Dot(refNormal, inc.m_normals[i]);
+        if (d < minDot) {
+            minDot = d;
+            incEdge = i;
+        }
+    }
+    Vec2 incident[2] = {inc.m_vertices[incEdge],
+                        inc.m_vertices[(incEdge + 1) % inc.m_count]};
+
+    const Vec2& v1 = ref.m_vertices[refEdge];
+    const Vec2& v2 = ref.m_vertices[(refEdge + 1) % ref.m_count];
+    Vec2 tangent = Normalize(v2 - v1);
+
+    Vec2 clip1[2];
+    Vec2 clip2[2];
+    RETURN_VALUE_IF_FALSE(
+        ClipSegment(incident, clip1, -tangent, -Dot(tangent, v1)) >= 2, 0);
+    RETURN_VALUE_IF_FALSE(
+        ClipSegment(clip1, clip2, tangent, Dot(tangent, v2)) >= 2, 0);
 
-    Vec2 vba =  bA->m_linearVel - bB->m_linearVel;
-    float impulseJ = -(1.0f + elasticity) * Dot(vba, contact.m_normal) /
-                     (bA->m_invMass + bB->m_invMass);
-    Vec2 vectorImpulseJ = contact.m_normal * impulseJ;
+    uint32_t count = 0;
+    for (const Vec2& p : clip2) {
+        float separation = Dot(refNormal, p - v1);
+        CONTINUE_IF(separation > 0);
+
+        Contact& contact = contacts[count++];
+        Vec2 onRef = p - separation * refNormal;
+        contact.m_normal = flip ? -refNormal : refNormal;
+        contact.m_sperateDist = -separation;
+        contact.m_ptOnAWorldSpace = flip ? p : onRef;
+        contact.m_ptOnBWorldSpace = flip ? onRef : p;
+    }
+    return count;
+}
+
+}  // namespace
+
+uint32_t CollidePolygons(const ShapePolygon& polyA,
+                         const Transform2D& transformA,
+                         const ShapePolygon& polyB,
+                         const Transform2D& transformB, CollideCache& cache,
+                         Contact* contacts) {
+    return CollideWorldPolygons(ToWorld(polyA, transformA),
+                                ToWorld(polyB, transformB), cache, contacts);
+}
+
+uint32_t CollidePolygonSphere(const ShapePolygon& poly,
+                              const Transform2D& transformA,
+                              const ShapeSphere& sphere,
+                              const Transform2D& transformB, CollideCache&,
+                              Contact* contacts) {
+    // work in the polygon's local space
+    Vec2 center = transformA.ApplyInverse(transformB.m_position);
+    float radius = sphere.m_radius;
+
+    uint32_t edge = 0;
+    float separation = -FLT_MAX;
+    for (uint32_t i = 0; i < poly.m_count; ++i) {
+        float s = Dot(poly.m_normals[i], center - poly.m_vertices[i]);
+        RETURN_VALUE_IF_FALSE(s <= radius, 0);
+        if (s > separation) {
+            separation = s;
+            edge = i;
+        }
+    }
+
+    const Vec2& v1 = poly.m_vertices[edge];
+    const Vec2& v2 = poly.m_vertices[(edge + 1) % poly.m_count];
+    Vec2 normal = poly.m_normals[edge];
+    Vec2 onPoly = center - separation * normal;
+    float dist = separation;
+
+    // outside beyond an end of the edge the closest feature is the vertex
+    if (separation > 0) {
+        const Vec2* vertex = nullptr;
+        if (Dot(center - v1, v2 - v1) <= 0) {
+            vertex = &v1;
+        } else if (Dot(center - v2, v1 - v2) <= 0) {
+            vertex = &v2;
+        }
+        if (vertex) {
+            dist = std::sqrt(LengthSqrd(center - *vertex));
+            RETURN_VALUE_IF_FALSE(dist <= radius && dist > 0, 0);
+            normal = (center - *vertex) / dist;
+            onPoly = *vertex;
+        }
+    }
+
+    Contact& contact = contacts[0];
+    contact.m_normal = transformA.m_rotation.Apply(normal);
+    contact.m_sperateDist = radius - dist;
+    contact.m_ptOnAWorldSpace = transformA.Apply(onPoly);
+    contact.m_ptOnBWorldSpace =
+        transformB.m_position - radius * contact.m_normal;
+    return 1;
+}
+
+void RegisterCollideFunc(Shape::ShapeType typeA, Shape::ShapeType typeB,
+                         CollideFunc func) {
+    auto& table = GetCollideTable();
+    size_t a = static_cast<size_t>(typeA);
+    size_t b = static_cast<size_t>(typeB);
+    table[a][b] = {func, false};
+    if (a != b) {
+        table[b][a] = {func, true};
+    }
+}
+
+uint32_t CollideConvex(const ConvexProxy& a, const ConvexProxy& b,
+                       CollideCache& cache, Contact* contacts) {
+    GjkResult result = GjkDistance(a, b, cache.m_simplex);
+    cache.m_gjkIterations = result.m_iterations;
+    float radius = a.GetRadius() + b.GetRadius();
+    RETURN_VALUE_IF_FALSE(result.m_distance <= radius, 0);
+
+    Contact& contact = contacts[0];
+    Vec2 pointA = result.m_pointA;
+    Vec2 pointB = result.m_pointB;
+    if (result.m_distance > CoreOverlapDistance) {
+        contact.m_normal = (pointB - pointA) / result.m_distance;
+        contact.m_sperateDist = radius - result.m_distance;
+    } else {
+        float depth = 0;
+        if (!EpaPenetration(a, b, cache.m_simplex, contact.m_normal, depth,
+                            pointA, pointB)) {
+            // flat cores touching, only the centers tell a direction
+            Vec2 offset = b.GetPosition() - a.GetPosition();
+            contact.m_normal = LengthSqrd(offset) > 0 ? Normalize(offset)
+                                                      : Vec2{0, 1};
+        }
+        contact.m_sperateDist = radius + depth;
+    }
+    contact.m_ptOnAWorldSpace = pointA + a.GetRadius() * contact.m_normal;
+    contact.m_ptOnBWorldSpace = pointB - b.GetRadius() * contact.m_normal;
+    return 1;
+}
+
+namespace {
+
+// fill the parts of contact that refer to the bodies from its world points
+void FillBodies(uint32_t a, const Transform2D& transformA, uint32_t b,
+                const Transform2D& transformB, Contact& contact) {
+    contact.m_ptOnALocalSpace =
+        transformA.ApplyInverse(contact.m_ptOnAWorldSpace);
+    contact.m_ptOnBLocalSpace =
+        transformB.ApplyInverse(contact.m_ptOnBWorldSpace);
+    contact.m_toi = 0;
+    contact.m_bodyA = a;
+    contact.m_bodyB = b;
+}
+
+uint32_t CollideShapes(const ShapeStorage& shapes, ShapeHandle shapeA,
+                       const Transform2D& transformA, ShapeHandle shapeB,
+                       const Transform2D& transformB, CollideCache& cache,
+                       Contact* contacts);
+
+// keep the deepest contacts when there are more than a manifold holds
+void AddContact(const Contact& contact, Contact* contacts, uint32_t& count) {
+    if (count < MaxManifoldContacts) {
+        contacts[count++] = contact;
+        return;
+    }
+    Contact* shallowest = std::min_element(
+        contacts, contacts + count, [](const Contact& a, const Contact& b) {
+            return a.m_sperateDist < b.m_sperateDist;
+        });
+    if (contact.m_sperateDist > shallowest->m_sperateDist) {
+        *shallowest = contact;
+    }
+}
+
+// children of compound A whose bounds overlap B against B
+uint32_t CollideCompound(const ShapeStorage& shapes,
+                         const ShapeCompound& compound,
+                         const Transform2D& transformA, ShapeHandle shapeB,
+                         const Transform2D& transformB, Contact* contacts) {
+    AABB localBounds =
+        shapes.GetBounds(shapeB, transformA.InvMul(transformB));
+
+    uint32_t count = 0;
+    auto& children = compound.GetChildren();
+    compound.QueryChildren(localBounds, [&](uint32_t i) {
+        // children share the pair, so they can't keep a cache of their own
+        CollideCache cache;
+        Contact childContacts[MaxManifoldContacts];
+        uint32_t childCount = CollideShapes(
+            shapes, children[i].m_shape,
+            transformA * compound.GetChildTransform(i), shapeB, transformB,
+            cache, childContacts);
+        for (uint32_t k = 0; k < childCount; ++k) {
+            AddContact(childContacts[k], contacts, count);
+        }
+    });
+    return count;
+}
+
+// a chain segment as a convex shape for the GJK
+struct SegmentShape {
+    Vec2 m_v1;
+    Vec2 m_v2;
+
+    Vec2 Support(const Vec2& direction) const {
+        return Dot(direction, m_v2 - m_v1) > 0 ? m_v2 : m_v1;
+    }
+    float GetRadius() const { return 0; }
+};
+
+// segment v1 -> v2 at the origin against shape B
+uint32_t CollideSegment(const ShapeStorage& shapes, const Vec2& v1,
+                        const Vec2& v2, const Vec2& normal, ShapeHandle shapeB,
+                        const Transform2D& transformB, Contact* contacts) {
+    // segments share the pair, so they can't keep a cache of their own
+    CollideCache cache;
+    if (shapeB.m_type == Shape::ShapeType::Polygon) {
+        // clipping gives polygons two contacts on a segment
+        WorldPolygon segment;
+        segment.m_count = 2;
+        segment.m_vertices[0] = v1;
+        segment.m_vertices[1] = v2;
+        segment.m_normals[0] = normal;
+        segment.m_normals[1] = -normal;
+        auto& poly = shapes.GetPool<ShapePolygon>()[shapeB.m_index];
+        return CollideWorldPolygons(segment, ToWorld(poly, transformB),
+                                    cache, contacts);
+    }
+
+    SegmentShape segment{v1, v2};
+    return shapes.Visit(shapeB, [&](const auto& shape) -> uint32_t {
+        if constexpr (requires { shape.Support(Vec2{}); }) {
+            return CollideConvex(ConvexProxy{segment, Transform2D{}},
+                                 ConvexProxy{shape, transformB}, cache,
+                                 contacts);
+        } else {
+            // compounds are split before, chains are static and never meet
+            return 0;
+        }
+    });
+}
+
+// segments of chain A whose bounds overlap B against B
+uint32_t CollideChain(const ShapeStorage& shapes, const ShapeChain& chain,
+                      const Transform2D& transformA, ShapeHandle shapeB,
+                      const Transform2D& transformB, Contact* contacts) {
+    // collide in the chain's local space and move the contacts back
+    Transform2D localB = transformA.InvMul(transformB);
+    Vec2 localCenterB = localB.Apply(shapes.Get(shapeB).GetCenterOfMass());
+
+    uint32_t count = 0;
+    AABB localBounds = shapes.GetBounds(shapeB, localB);
+    chain.QuerySegments(localBounds, [&](uint32_t i) {
+        Vec2 v1, v2;
+        chain.GetSegment(i, v1, v2);
+        Vec2 e = v2 - v1;
+        Vec2 normal = Normalize(Vec2{e.y, -e.x});
+        // bodies behind a one-sided segment pass through it
+        bool oneSided = chain.IsOneSided();
+        RETURN_IF_FALSE(!oneSided || Dot(normal, localCenterB - v1) >= 0);
+
+        Contact segmentContacts[MaxManifoldContacts];
+        uint32_t segmentCount =
+            CollideSegment(shapes, v1, v2, normal, shapeB, localB,
+                           segmentContacts);
+        for (uint32_t k = 0; k < segmentCount; ++k) {
+            Contact& contact = segmentContacts[k];
+            CONTINUE_IF(oneSided && Dot(contact.m_normal, normal) <= 0);
+            contact.m_normal = transformA.m_rotation.Apply(contact.m_normal);
+            contact.m_ptOnAWorldSpace =
+                transformA.Apply(contact.m_ptOnAWorldSpace);
+            contact.m_ptOnBWorldSpace =
+                transformA.Apply(contact.m_ptOnBWorldSpace);
+            AddContact(contact, contacts, count);
+        }
+    });
+    return count;
+}
+
+// contacts of two shapes at the given transforms, only the geometric part
+uint32_t CollideShapes(const ShapeStorage& shapes, ShapeHandle shapeA,
+                       const Transform2D& transformA, ShapeHandle shapeB,
+                       const Transform2D& transformB, CollideCache& cache,
+                       Contact* contacts) {
+    if (shapeA.m_type == Shape::ShapeType::Sphere &&
+        shapeB.m_type == Shape::ShapeType::Sphere) {
+        // the most common pair skips the table
+        auto& spheres = shapes.GetPool<ShapeSphere>();
+        return CollideSphereSphere(spheres[shapeA.m_index], transformA,
+                                   spheres[shapeB.m_index], transformB,
+                                   cache, contacts);
+    }
+
+    if (shapeA.m_type == Shape::ShapeType::Compound) {
+        auto& compound = shapes.GetPool<ShapeCompound>()[shapeA.m_index];
+        return CollideCompound(shapes, compound, transformA, shapeB,
+                               transformB, contacts);
+    }
+    if (shapeB.m_type == Shape::ShapeType::Compound) {
+        auto& compound = shapes.GetPool<ShapeCompound>()[shapeB.m_index];
+        uint32_t count = CollideCompound(shapes, compound, transformB,
+                                         shapeA, transformA, contacts);
+        for (uint32_t i = 0; i < count; ++i) {
+            SwapContact(contacts[i]);
+        }
+        return count;
+    }
+
+    if (shapeA.m_type == Shape::ShapeType::Chain) {
+        auto& chain = shapes.GetPool<ShapeChain>()[shapeA.m_index];
+        return CollideChain(shapes, chain, transformA, shapeB, transformB,
+                            contacts);
+    }
+    if (shapeB.m_type == Shape::ShapeType::Chain) {
+        auto& chain = shapes.GetPool<ShapeChain>()[shapeB.m_index];
+        uint32_t count = CollideChain(shapes, chain, transformB, shapeA,
+                                      transformA, contacts);
+        for (uint32_t i = 0; i < count; ++i) {
+            SwapContact(contacts[i]);
+        }
+        return count;
+    }
+
+    auto& entry = GetCollideTable()[static_cast<size_t>(shapeA.m_type)]
+                                   [static_cast<size_t>(shapeB.m_type)];
+    RETURN_VALUE_IF_FALSE(entry.m_func, 0);
+    if (!entry.m_swap) {
+        return entry.m_func(shapes.Get(shapeA), transformA,
+                            shapes.Get(shapeB), transformB, cache, contacts);
+    }
+    uint32_t count = entry.m_func(shapes.Get(shapeB), transformB,
+                                  shapes.Get(shapeA), transformA, cache,
+                                  contacts);
+    for (uint32_t i = 0; i < count; ++i) {
+        SwapContact(contacts[i]);
+    }
+    return count;
+}
+
+// shapes of bodies a and b placed at the given transforms
+uint32_t CollideAt(const BodyStorage& bodies, uint32_t a,
+                   const Transform2D& transformA, uint32_t b,
+                   const Transform2D& transformB, CollideCache& cache,
+                   Contact* contacts) {
+    uint32_t count =
+        CollideShapes(bodies.GetShapes(), bodies.m_shapes[a], transformA,
+                      bodies.m_shapes[b], transformB, cache, contacts);
+    assert(count <= MaxManifoldContacts);
+    for (uint32_t i = 0; i < count; ++i) {
+        FillBodies(a, transformA, b, transformB, contacts[i]);
+    }
+    return count;
+}
+
+bool SphereTimeOfImpact(float radiusA, const Vec2& startA,
+                        const Vec2& translation, float radiusB,
+                        const Vec2& posB, float& toi) {
+    // solve |startA + t * translation - posB| = radiusA + radiusB
+    Vec2 p = startA - posB;
+    float radiusSum = radiusA + radiusB;
+    float c = LengthSqrd(p) - radiusSum * radiusSum;
+    // touching at the start is left to the regular contacts
+    RETURN_FALSE_IF_FALSE(c > 0);
+
+    float b = Dot(p, translation);
+    RETURN_FALSE_IF_FALSE(b < 0);
+
+    float a = LengthSqrd(translation);
+    float disc = b * b - a * c;
+    RETURN_FALSE_IF_FALSE(disc >= 0);
+
+    toi = (-b - std::sqrt(disc)) / a;
+    return toi <= 1.0f;
+}
+
+/**
+ * @brief conservative advancement of convex A moving by translation against
+ * convex B at rest: A advances by the distance over the approach speed
+ * along the closest points, which can't pass the first touch as the
+ * distance of translated convex shapes is convex in time
+ * @note fills the geometric part of contact
+ */
+template <typename A, typename B>
+bool ConvexTimeOfImpact(const A& shapeA, const Transform2D& startA,
+                        const Vec2& translation, const B& shapeB,
+                        const Transform2D& transformB, Contact& contact) {
+    ConvexProxy proxyB{shapeB, transformB};
+    float radiusA = shapeA.GetRadius();
+    float radiusB = shapeB.GetRadius();
+    GjkSimplex simplex;
+    float t = 0;
+    for (uint32_t i = 1;; ++i) {
+        Transform2D transformA{startA.m_position + translation * t,
+                               startA.m_rotation};
+        GjkResult result =
+            GjkDistance(ConvexProxy{shapeA, transformA}, proxyB, simplex);
+        // overlapping cores only happen at the start, every advance stops
+        // short of the touch
+        RETURN_FALSE_IF_FALSE(result.m_distance > CoreOverlapDistance);
+
+        Vec2 normal = (result.m_pointB - result.m_pointA) / result.m_distance;
+        float approach = Dot(translation, normal);
+        RETURN_FALSE_IF_FALSE(approach > 0);
+
+        float distance = result.m_distance - radiusA - radiusB;
+        if (distance <= TimeOfImpactTolerance ||
+            i == MaxTimeOfImpactIterations) {
+            contact.m_normal = normal;
+            contact.m_sperateDist = distance;
+            contact.m_ptOnAWorldSpace = result.m_pointA + normal * radiusA;
+            contact.m_ptOnBWorldSpace = result.m_pointB - normal * radiusB;
+            contact.m_toi = t;
+            return true;
+        }
+
+        // aim a little short so the next query still has apart cores
+        t += (distance - 0.5f * TimeOfImpactTolerance) / approach;
+        RETURN_FALSE_IF_FALSE(t <= 1.0f);
+    }
+}
+
+// bounds of a world space box in the local space of transform
+AABB ToLocalBounds(const AABB& bounds, const Transform2D& transform) {
+    AABB local = AABB::Empty();
+    for (const Vec2& corner :
+         {bounds.m_min, Vec2{bounds.m_max.x, bounds.m_min.y}, bounds.m_max,
+          Vec2{bounds.m_min.x, bounds.m_max.y}}) {
+        Vec2 p = transform.ApplyInverse(corner);
+        local = AABB::Merge(local, AABB{p, p});
+    }
+    return local;
+}
+
+/**
+ * @brief call f(shape, transform) with every convex piece of a shape whose
+ * bounds overlap bounds in world space: the shape itself, the children of a
+ * compound or the segments of a chain
+ * @param otherCenter  segments of a one-sided chain facing away from it are
+ * skipped, like in CollideChain
+ */
+template <typename F>
+void ForEachConvexPiece(const ShapeStorage& shapes, ShapeHandle handle,
+                        const Transform2D& transform, const AABB& bounds,
+                        const Vec2& otherCenter, F&& f) {
+    auto visitConvex = [&](ShapeHandle piece, const Transform2D& at) {
+        shapes.Visit(piece, [&](const auto& shape) {
+            if constexpr (requires { shape.Support(Vec2{}); }) {
+                f(shape, at);
+            }
+        });
+    };
+
+    if (handle.m_type == Shape::ShapeType::Compound) {
+        auto& compound = shapes.GetPool<ShapeCompound>()[handle.m_index];
+        compound.QueryChildren(
+            ToLocalBounds(bounds, transform), [&](uint32_t i) {
+                visitConvex(compound.GetChildren()[i].m_shape,
+                            transform * compound.GetChildTransform(i));
+            });
+        return;
+    }
+    if (handle.m_type == Shape::ShapeType::Chain) {
+        auto& chain = shapes.GetPool<ShapeChain>()[handle.m_index];
+        Vec2 localCenter = transform.ApplyInverse(otherCenter);
+        chain.QuerySegments(
+            ToLocalBounds(bounds, transform), [&](uint32_t i) {
+                Vec2 v1, v2;
+                chain.GetSegment(i, v1, v2);
+                Vec2 e = v2 - v1;
+                RETURN_IF_FALSE(!chain.IsOneSided() ||
+                                Dot(Vec2{e.y, -e.x}, localCenter - v1) >= 0);
+                f(SegmentShape{v1, v2}, transform);
+            });
+        return;
+    }
+    visitConvex(handle, transform);
+}
+
+}  // namespace
+
+uint32_t Intersect(const BodyStorage& bodies, uint32_t a, uint32_t b,
+                   CollideCache& cache, Contact* contacts) {
+    return CollideAt(bodies, a, bodies.GetTransform(a), b,
+                     bodies.GetTransform(b), cache, contacts);
+}
+
+bool TimeOfImpact(const BodyStorage& bodies, uint32_t a, const Vec2& startA,
+                  const Vec2& translation, uint32_t b, Contact& contact) {
+    ShapeHandle shapeA = bodies.m_shapes[a];
+    ShapeHandle shapeB = bodies.m_shapes[b];
+    Transform2D transformB = bodies.GetTransform(b);
+    const Vec2& posB = transformB.m_position;
+    const Rotation2D& rotationA = bodies.m_cosSins[a];
+    // A at a fraction of the sweep
+    auto sweptA = [&](float t) {
+        return Transform2D{startA + translation * t, rotationA};
+    };
+    auto& shapes = bodies.GetShapes();
+    RETURN_FALSE_IF_FALSE(LengthSqrd(translation) > 0);
+
+    float toi = 0;
+    if (shapeA.m_type == Shape::ShapeType::Sphere &&
+        shapeB.m_type == Shape::ShapeType::Sphere) {
+        auto& spheres = shapes.GetPool<ShapeSphere>();
+        float radiusA = spheres[shapeA.m_index].m_radius;
+        float radiusB = spheres[shapeB.m_index].m_radius;
+        RETURN_FALSE_IF_FALSE(SphereTimeOfImpact(radiusA, startA, translation,
+                                                 radiusB, posB, toi));
+
+        // exactly touching, so the centers are radius sum apart
+        Vec2 posA = startA + translation * toi;
+        contact.m_normal = (posB - posA) / (radiusA + radiusB);
+        contact.m_sperateDist = 0;
+        contact.m_ptOnAWorldSpace = posA + radiusA * contact.m_normal;
+        contact.m_ptOnBWorldSpace = posB - radiusB * contact.m_normal;
+        FillBodies(a, Transform2D{posA, rotationA}, b, transformB, contact);
+        contact.m_toi = toi;
+        return true;
+    }
 
-    bA->ApplyLinearImpulse(vectorImpulseJ);
-    bA->ApplyLinearImpulse(-vectorImpulseJ);
+    // touching at the start is left to the regular contacts
+    CollideCache cache;
+    Contact samples[MaxManifoldContacts];
+    RETURN_FALSE_IF_FALSE(
+        !CollideAt(bodies, a, sweptA(0), b, transformB, cache, samples));
 
-    float tA = bA->m_invMass / (bA->m_invMass + bB->m_invMass);
-    float tB = bB->m_invMass / (bA->m_invMass + bB->m_invMass);
+    // pieces of A that B can reach and pieces of B that A sweeps over
+    AABB boundsA = AABB::Merge(shapes.GetBounds(shapeA, sweptA(0)),
+                               shapes.GetBounds(shapeA, sweptA(1)));
+    AABB boundsB = shapes.GetBounds(shapeB, transformB);
+    boundsB = AABB::Merge(boundsB, AABB{boundsB.m_min - translation,
+                                        boundsB.m_max - translation});
+    Vec2 centerA = sweptA(0).Apply(shapes.Get(shapeA).GetCenterOfMass());
+    Vec2 centerB = transformB.Apply(shapes.Get(shapeB).GetCenterOfMass());
 
-    Vec2 ds = contact.m_ptOnBWorldSpace - contact.m_ptOnAWorldSpace;
+    bool found = false;
+    ForEachConvexPiece(
+        shapes, shapeA, sweptA(0), boundsB, centerB,
+        [&](const auto& pieceA, const Transform2D& startPieceA) {
+            ForEachConvexPiece(
+                shapes, shapeB, transformB, boundsA, centerA,
+                [&](const auto& pieceB, const Transform2D& transformPieceB) {
+                    Contact pieceContact;
+                    RETURN_IF_FALSE(ConvexTimeOfImpact(
+                        pieceA, startPieceA, translation, pieceB,
+                        transformPieceB, pieceContact));
+                    RETURN_IF_FALSE(!found ||
+                                    pieceContact.m_toi < contact.m_toi);
+                    found = true;
+                    contact = pieceContact;
+                });
+        });
+    RETURN_FALSE_IF_FALSE(found);
 
-    bA->m_position += ds * tA;
-    bA->m_position -= ds * tB;
+    toi = contact.m_toi;
+    FillBodies(a, sweptA(toi), b, transformB, contact);
+    contact.m_toi = toi;
+    return true;
 }
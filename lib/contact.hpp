@@ -1,5 +1,6 @@
 #pragma once
 #include "body.hpp"
+#include "gjk.hpp"
 #include "math/math.hpp"
 
 struct Contact {
@@ -12,9 +13,142 @@ struct Contact {
     float m_sperateDist;
     float m_toi;
 
-    BodyPtr m_bodyA;
-    BodyPtr m_bodyB;
+    // indices in BodyStorage
+    uint32_t m_bodyA;
+    uint32_t m_bodyB;
 };
 
-bool Intersect(BodyPtr&, BodyPtr&, Contact&);
-void ResolveContact(Contact&);
+// contacts of one shape pair, a clipped edge gives two and a compound
+// touching with several children more
+constexpr uint32_t MaxManifoldContacts = 4;
+
+/**
+ * @brief per pair state kept between steps to speed up the narrowphase
+ * @note meaning is up to the collide function of the pair, it's reset when
+ * the pair stops overlapping in the broadphase
+ */
+struct CollideCache {
+    // separating axis test: the shape owning the axis (0 first, 1 second,
+    // -1 none) and its edge
+    int8_t m_axisOwner = -1;
+    uint8_t m_axisEdge = 0;
+
+    // GJK: the simplex of the last query warm starts the next one
+    GjkSimplex m_simplex;
+    uint32_t m_gjkIterations = 0;  // of the last query, for stats
+};
+
+/**
+ * @brief narrowphase of one shape pair, only fills the geometric part of the
+ * contacts, normal points from A to B
+ * @return count of contacts written, at most MaxManifoldContacts
+ */
+using CollideFunc = uint32_t (*)(const Shape& shapeA,
+                                 const Transform2D& transformA,
+                                 const Shape& shapeB,
+                                 const Transform2D& transformB,
+                                 CollideCache& cache, Contact* contacts);
+
+template <typename A, typename B>
+using TypedCollideFunc = uint32_t (*)(const A&, const Transform2D&,
+                                      const B&, const Transform2D&,
+                                      CollideCache&, Contact*);
+
+/**
+ * @brief put func into the dispatch table, (typeB, typeA) is filled too and
+ * calls func with swapped arguments
+ */
+void RegisterCollideFunc(Shape::ShapeType typeA, Shape::ShapeType typeB,
+                         CollideFunc func);
+
+template <typename A, typename B, TypedCollideFunc<A, B> F>
+uint32_t CollideAdapter(const Shape& shapeA, const Transform2D& transformA,
+                        const Shape& shapeB, const Transform2D& transformB,
+                        CollideCache& cache, Contact* contacts) {
+    return F(static_cast<const A&>(shapeA), transformA,
+             static_cast<const B&>(shapeB), transformB, cache, contacts);
+}
+
+template <typename A, typename B, TypedCollideFunc<A, B> F>
+void RegisterCollideFunc() {
+    RegisterCollideFunc(A::Type, B::Type, &CollideAdapter<A, B, F>);
+}
+
+inline uint32_t CollideSphereSphere(const ShapeSphere& sphereA,
+                                    const Transform2D& transformA,
+                                    const ShapeSphere& sphereB,
+                                    const Transform2D& transformB,
+                                    CollideCache&, Contact* contacts) {
+    const Vec2& posA = transformA.m_position;
+    const Vec2& posB = transformB.m_position;
+    float radiusSum = sphereA.m_radius + sphereB.m_radius;
+    float distSquard = LengthSqrd(posA - posB);
+    RETURN_VALUE_IF_FALSE(distSquard <= radiusSum * radiusSum, 0);
+
+    float dist = std::sqrt(distSquard);
+
+    // coincident centers have no direction, pick any unit normal
+    Contact& contact = contacts[0];
+    contact.m_normal = dist == 0 ? Vec2{0, 1} : (posB - posA) / dist;
+    contact.m_sperateDist = std::abs(dist - radiusSum);
+    contact.m_ptOnAWorldSpace = posA + sphereA.m_radius * contact.m_normal;
+    contact.m_ptOnBWorldSpace = posB - sphereB.m_radius * contact.m_normal;
+    return 1;
+}
+
+/**
+ * @brief separating axis test, the axis found is cached and tested first
+ * next time so separated pairs usually cost one projection
+ */
+uint32_t CollidePolygons(const ShapePolygon& polyA,
+                         const Transform2D& transformA,
+                         const ShapePolygon& polyB,
+                         const Transform2D& transformB, CollideCache& cache,
+                         Contact* contacts);
+
+uint32_t CollidePolygonSphere(const ShapePolygon& poly,
+                              const Transform2D& transformA,
+                              const ShapeSphere& sphere,
+                              const Transform2D& transformB,
+                              CollideCache& cache, Contact* contacts);
+
+/**
+ * @brief one contact from GJK on the cores and EPA when the cores overlap,
+ * works for any pair of convex proxies
+ */
+uint32_t CollideConvex(const ConvexProxy& a, const ConvexProxy& b,
+                       CollideCache& cache, Contact* contacts);
+
+template <typename A, typename B>
+uint32_t CollideConvex(const A& shapeA, const Transform2D& transformA,
+                       const B& shapeB, const Transform2D& transformB,
+                       CollideCache& cache, Contact* contacts) {
+    return CollideConvex(ConvexProxy{shapeA, transformA},
+                         ConvexProxy{shapeB, transformB}, cache, contacts);
+}
+
+/**
+ * @brief collide A and B through their support mappings, a new convex shape
+ * only needs this for each shape it meets
+ */
+template <typename A, typename B>
+void RegisterConvexCollideFunc() {
+    RegisterCollideFunc<A, B, CollideConvex<A, B>>();
+}
+
+/**
+ * @brief contacts of bodies a and b at their current transforms
+ * @param contacts  room for MaxManifoldContacts
+ * @return count of contacts
+ */
+uint32_t Intersect(const BodyStorage& bodies, uint32_t a, uint32_t b,
+                   CollideCache& cache, Contact* contacts);
+
+/**
+ * @brief sweep body a from startA by translation against b held at its
+ * current transform
+ * @return true if they start apart and touch within the sweep, contact is
+ * filled at the time of impact and m_toi is its fraction of the sweep
+ */
+bool TimeOfImpact(const BodyStorage& bodies, uint32_t a, const Vec2& startA,
+                  const Vec2& translation, uint32_t b, Contact& contact);
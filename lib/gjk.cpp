@@ -0,0 +1,389 @@
+#include "gjk.hpp"
+
+#include "macro.hpp"
+#include <algorithm>
+#include <cfloat>
+
+namespace {
+
+constexpr uint32_t MaxGjkIterations = 20;
+constexpr uint32_t MaxEpaVertices = 32;
+constexpr float EpaTolerance = 1e-3f;
+constexpr uint32_t MaxRayCastIterations = 20;
+constexpr float RayCastTolerance = 1e-3f;
+
+// below this the search direction is lost to round off
+constexpr float DirectionEpsilon = 1e-6f;
+
+struct SimplexVertex {
+    Vec2 m_localA;
+    Vec2 m_localB;
+    Vec2 m_pointA;
+    Vec2 m_pointB;
+    Vec2 m_w;   // m_pointB - m_pointA
+    float m_a;  // barycentric weight of the closest point
+};
+
+bool IsSamePoint(const Vec2& a, const Vec2& b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+SimplexVertex MakeVertex(const ConvexProxy& a, const ConvexProxy& b,
+                         const Vec2& localA, const Vec2& localB) {
+    SimplexVertex v;
+    v.m_localA = localA;
+    v.m_localB = localB;
+    v.m_pointA = a.ToWorld(localA);
+    v.m_pointB = b.ToWorld(localB);
+    v.m_w = v.m_pointB - v.m_pointA;
+    v.m_a = 1;
+    return v;
+}
+
+// the vertex of the Minkowski difference B - A furthest along direction
+SimplexVertex SupportVertex(const ConvexProxy& a, const ConvexProxy& b,
+                            const Vec2& direction) {
+    return MakeVertex(a, b, a.GetLocalSupport(-direction),
+                      b.GetLocalSupport(direction));
+}
+
+struct Simplex {
+    SimplexVertex m_v[GjkSimplex::MaxVertices];
+    uint32_t m_count;
+
+    void Read(const ConvexProxy& a, const ConvexProxy& b,
+              const GjkSimplex& cache) {
+        m_count = cache.m_count;
+        for (uint32_t i = 0; i < m_count; ++i) {
+            m_v[i] = MakeVertex(a, b, cache.m_localA[i], cache.m_localB[i]);
+        }
+
+        // the shapes moved, a cached simplex gone flat can't be solved
+        bool degenerate = false;
+        if (m_count == 2) {
+            degenerate = LengthSqrd(m_v[1].m_w - m_v[0].m_w) <
+                         DirectionEpsilon * DirectionEpsilon;
+        } else if (m_count == 3) {
+            degenerate = std::abs(Cross(m_v[1].m_w - m_v[0].m_w,
+                                        m_v[2].m_w - m_v[0].m_w)) <
+                         DirectionEpsilon;
+        }
+        if (degenerate) {
+            m_count = 1;
+        }
+
+        if (m_count == 0) {
+            Vec2 d = b.GetPosition() - a.GetPosition();
+            if (LengthSqrd(d) < DirectionEpsilon * DirectionEpsilon) {
+                d = Vec2{1, 0};
+            }
+            m_v[0] = SupportVertex(a, b, -d);
+            m_count = 1;
+        }
+    }
+
+    void Write(GjkSimplex& cache) const {
+        cache.m_count = m_count;
+        for (uint32_t i = 0; i < m_count; ++i) {
+            cache.m_localA[i] = m_v[i].m_localA;
+            cache.m_localB[i] = m_v[i].m_localB;
+        }
+    }
+
+    Vec2 GetSearchDirection() const {
+        if (m_count == 1) {
+            return -m_v[0].m_w;
+        }
+        // perpendicular to the edge is more precise than minus the closest
+        // point when the origin is near the edge
+        Vec2 e12 = m_v[1].m_w - m_v[0].m_w;
+        if (Cross(e12, -m_v[0].m_w) > 0) {
+            return Vec2{-e12.y, e12.x};
+        }
+        return Vec2{e12.y, -e12.x};
+    }
+
+    void GetWitnessPoints(Vec2& pointA, Vec2& pointB) const {
+        pointA = Vec2{0, 0};
+        pointB = Vec2{0, 0};
+        for (uint32_t i = 0; i < m_count; ++i) {
+            pointA += m_v[i].m_pointA * m_v[i].m_a;
+            pointB += m_v[i].m_pointB * m_v[i].m_a;
+        }
+        // the cores overlap, the origin is inside the triangle
+        if (m_count == 3) {
+            pointB = pointA;
+        }
+    }
+
+    // closest point of segment w1 w2 to the origin by barycentric weights
+    void Solve2() {
+        const Vec2& w1 = m_v[0].m_w;
+        const Vec2& w2 = m_v[1].m_w;
+        Vec2 e12 = w2 - w1;
+
+        float d12_2 = -Dot(w1, e12);
+        if (d12_2 <= 0) {
+            m_v[0].m_a = 1;
+            m_count = 1;
+            return;
+        }
+        float d12_1 = Dot(w2, e12);
+        if (d12_1 <= 0) {
+            m_v[1].m_a = 1;
+            m_v[0] = m_v[1];
+            m_count = 1;
+            return;
+        }
+        float inv = 1 / (d12_1 + d12_2);
+        m_v[0].m_a = d12_1 * inv;
+        m_v[1].m_a = d12_2 * inv;
+    }
+
+    // closest feature of triangle w1 w2 w3 to the origin, checks vertex,
+    // edge and face regions in turn
+    void Solve3() {
+        const Vec2& w1 = m_v[0].m_w;
+        const Vec2& w2 = m_v[1].m_w;
+        const Vec2& w3 = m_v[2].m_w;
+
+        Vec2 e12 = w2 - w1;
+        float d12_1 = Dot(w2, e12);
+        float d12_2 = -Dot(w1, e12);
+
+        Vec2 e13 = w3 - w1;
+        float d13_1 = Dot(w3, e13);
+        float d13_2 = -Dot(w1, e13);
+
+        Vec2 e23 = w3 - w2;
+        float d23_1 = Dot(w3, e23);
+        float d23_2 = -Dot(w2, e23);
+
+        float n123 = Cross(e12, e13);
+        float d123_1 = n123 * Cross(w2, w3);
+        float d123_2 = n123 * Cross(w3, w1);
+        float d123_3 = n123 * Cross(w1, w2);
+
+        if (d12_2 <= 0 && d13_2 <= 0) {
+            m_v[0].m_a = 1;
+            m_count = 1;
+            return;
+        }
+        if (d12_1 > 0 && d12_2 > 0 && d123_3 <= 0) {
+            float inv = 1 / (d12_1 + d12_2);
+            m_v[0].m_a = d12_1 * inv;
+            m_v[1].m_a = d12_2 * inv;
+            m_count = 2;
+            return;
+        }
+        if (d13_1 > 0 && d13_2 > 0 && d123_2 <= 0) {
+            float inv = 1 / (d13_1 + d13_2);
+            m_v[0].m_a = d13_1 * inv;
+            m_v[2].m_a = d13_2 * inv;
+            m_v[1] = m_v[2];
+            m_count = 2;
+            return;
+        }
+        if (d12_1 <= 0 && d23_2 <= 0) {
+            m_v[1].m_a = 1;
+            m_v[0] = m_v[1];
+            m_count = 1;
+            return;
+        }
+        if (d13_1 <= 0 && d23_1 <= 0) {
+            m_v[2].m_a = 1;
+            m_v[0] = m_v[2];
+            m_count = 1;
+            return;
+        }
+        if (d23_1 > 0 && d23_2 > 0 && d123_1 <= 0) {
+            float inv = 1 / (d23_1 + d23_2);
+            m_v[1].m_a = d23_1 * inv;
+            m_v[2].m_a = d23_2 * inv;
+            m_v[0] = m_v[2];
+            m_count = 2;
+            return;
+        }
+
+        float inv = 1 / (d123_1 + d123_2 + d123_3);
+        m_v[0].m_a = d123_1 * inv;
+        m_v[1].m_a = d123_2 * inv;
+        m_v[2].m_a = d123_3 * inv;
+    }
+};
+
+// a point has no extent, rays are cast as a point against the shape
+struct PointShape {
+    Vec2 Support(const Vec2&) const { return Vec2{0, 0}; }
+    float GetRadius() const { return 0; }
+};
+
+}  // namespace
+
+GjkResult GjkDistance(const ConvexProxy& a, const ConvexProxy& b,
+                      GjkSimplex& cache) {
+    Simplex simplex;
+    simplex.Read(a, b, cache);
+
+    GjkResult result;
+    result.m_iterations = 0;
+    Vec2 savedA[GjkSimplex::MaxVertices];
+    Vec2 savedB[GjkSimplex::MaxVertices];
+    while (true) {
+        uint32_t savedCount = simplex.m_count;
+        for (uint32_t i = 0; i < savedCount; ++i) {
+            savedA[i] = simplex.m_v[i].m_localA;
+            savedB[i] = simplex.m_v[i].m_localB;
+        }
+
+        if (simplex.m_count == 2) {
+            simplex.Solve2();
+        } else if (simplex.m_count == 3) {
+            simplex.Solve3();
+        }
+        BREAK_IF_FALSE(simplex.m_count < 3);
+        // checked after solving so the witness points never read the
+        // weights of a vertex added in the last iteration
+        BREAK_IF_FALSE(result.m_iterations < MaxGjkIterations);
+        result.m_iterations++;
+
+        Vec2 d = simplex.GetSearchDirection();
+        // the origin is on the simplex, the cores touch
+        BREAK_IF_FALSE(LengthSqrd(d) >= DirectionEpsilon * DirectionEpsilon);
+
+        SimplexVertex v = SupportVertex(a, b, d);
+
+        // cores are polytopes, so no new vertex means no progress
+        bool duplicate = false;
+        for (uint32_t i = 0; i < savedCount && !duplicate; ++i) {
+            duplicate = IsSamePoint(v.m_localA, savedA[i]) &&
+                        IsSamePoint(v.m_localB, savedB[i]);
+        }
+        BREAK_IF_FALSE(!duplicate);
+
+        simplex.m_v[simplex.m_count++] = v;
+    }
+
+    simplex.GetWitnessPoints(result.m_pointA, result.m_pointB);
+    result.m_distance = simplex.m_count == 3
+                            ? 0
+                            : Length(result.m_pointB - result.m_pointA);
+    simplex.Write(cache);
+    return result;
+}
+
+bool EpaPenetration(const ConvexProxy& a, const ConvexProxy& b,
+                    const GjkSimplex& cache, Vec2& normal, float& depth,
+                    Vec2& pointA, Vec2& pointB) {
+    SimplexVertex polytope[MaxEpaVertices];
+    uint32_t count = cache.m_count;
+    for (uint32_t i = 0; i < count; ++i) {
+        polytope[i] = MakeVertex(a, b, cache.m_localA[i], cache.m_localB[i]);
+    }
+
+    // the cores only touch at a point or an edge, grow it to a triangle
+    if (count == 0) {
+        polytope[count++] = SupportVertex(a, b, Vec2{1, 0});
+    }
+    if (count == 1) {
+        polytope[count++] = SupportVertex(a, b, -polytope[0].m_w);
+        if (LengthSqrd(polytope[1].m_w - polytope[0].m_w) <
+            DirectionEpsilon * DirectionEpsilon) {
+            polytope[1] = SupportVertex(a, b, Vec2{1, 0});
+        }
+    }
+    if (count == 2) {
+        Vec2 e = polytope[1].m_w - polytope[0].m_w;
+        Vec2 perp{-e.y, e.x};
+        polytope[2] = SupportVertex(a, b, perp);
+        if (Dot(perp, polytope[2].m_w - polytope[0].m_w) <
+            DirectionEpsilon) {
+            polytope[2] = SupportVertex(a, b, -perp);
+        }
+        count = 3;
+    }
+    float area = Cross(polytope[1].m_w - polytope[0].m_w,
+                       polytope[2].m_w - polytope[0].m_w);
+    RETURN_FALSE_IF_FALSE(std::abs(area) >= DirectionEpsilon);
+    if (area < 0) {
+        std::swap(polytope[1], polytope[2]);
+    }
+
+    // grow the counter clockwise polytope at its edge closest to the origin
+    // until the support point along its normal adds nothing
+    uint32_t edge = 0;
+    Vec2 n{0, 0};
+    float dist = 0;
+    while (true) {
+        dist = FLT_MAX;
+        for (uint32_t i = 0; i < count; ++i) {
+            Vec2 e = polytope[(i + 1) % count].m_w - polytope[i].m_w;
+            float len = Length(e);
+            CONTINUE_IF(len < DirectionEpsilon);
+            Vec2 edgeNormal = Vec2{e.y, -e.x} / len;
+            float d = Dot(edgeNormal, polytope[i].m_w);
+            if (d < dist) {
+                dist = d;
+                edge = i;
+                n = edgeNormal;
+            }
+        }
+        RETURN_FALSE_IF_FALSE(dist < FLT_MAX);
+
+        SimplexVertex v = SupportVertex(a, b, n);
+        BREAK_IF_FALSE(Dot(n, v.m_w) - dist > EpaTolerance &&
+                       count < MaxEpaVertices);
+        std::copy_backward(polytope + edge + 1, polytope + count,
+                           polytope + count + 1);
+        polytope[edge + 1] = v;
+        count++;
+    }
+
+    // the origin projects to dist * n on the edge
+    const SimplexVertex& v1 = polytope[edge];
+    const SimplexVertex& v2 = polytope[(edge + 1) % count];
+    Vec2 e = v2.m_w - v1.m_w;
+    float t = std::clamp(Dot(n * dist - v1.m_w, e) / LengthSqrd(e), 0.0f,
+                         1.0f);
+    pointA = v1.m_pointA + (v2.m_pointA - v1.m_pointA) * t;
+    pointB = v1.m_pointB + (v2.m_pointB - v1.m_pointB) * t;
+
+    // moving B by -n * dist separates them, so A to B is -n
+    normal = -n;
+    depth = dist;
+    return true;
+}
+
+bool ConvexRayCast(const ConvexProxy& proxy, const Vec2& from, const Vec2& to,
+                   float& fraction, Vec2& normal) {
+    static const PointShape point;
+    Vec2 dir = to - from;
+    float radius = proxy.GetRadius();
+
+    // step along the ray by the gap to the shape over the closing speed,
+    // which never passes the surface of a convex shape
+    GjkSimplex simplex;
+    float t = 0;
+    for (uint32_t i = 0; i < MaxRayCastIterations; ++i) {
+        Vec2 p = from + dir * t;
+        GjkResult result =
+            GjkDistance(ConvexProxy{point, Transform2D{p, Rotation2D{}}},
+                        proxy, simplex);
+        RETURN_FALSE_IF_FALSE(result.m_distance > 0);
+
+        float gap = result.m_distance - radius;
+        Vec2 n = (p - result.m_pointB) / result.m_distance;
+        if (gap < RayCastTolerance) {
+            RETURN_FALSE_IF_FALSE(t > 0);
+            fraction = t;
+            normal = n;
+            return true;
+        }
+
+        float approach = -Dot(n, dir);
+        RETURN_FALSE_IF_FALSE(approach > 0);
+        t += gap / approach;
+        RETURN_FALSE_IF_FALSE(t <= fraction);
+    }
+    return false;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "math/math.hpp"
+#include "transform.hpp"
+#include <cstdint>
+
+/**
+ * @brief a convex shape placed in world space seen through its support
+ * mapping: the core point furthest along a direction, rounded by a radius
+ * @note T needs Vec2 Support(const Vec2& direction) const in its local space
+ * and float GetRadius() const. The proxy refers to shape, it must outlive it
+ */
+class ConvexProxy {
+public:
+    template <typename T>
+    ConvexProxy(const T& shape, const Transform2D& transform)
+        : m_shape{&shape},
+          m_support{&support<T>},
+          m_transform{transform},
+          m_radius{shape.GetRadius()} {}
+
+    // core point furthest along a world space direction, in local space
+    Vec2 GetLocalSupport(const Vec2& direction) const {
+        return m_support(m_shape,
+                         m_transform.m_rotation.ApplyInverse(direction));
+    }
+
+    Vec2 ToWorld(const Vec2& local) const { return m_transform.Apply(local); }
+
+    const Vec2& GetPosition() const { return m_transform.m_position; }
+    float GetRadius() const { return m_radius; }
+
+private:
+    using SupportFunc = Vec2 (*)(const void* shape, const Vec2& direction);
+
+    template <typename T>
+    static Vec2 support(const void* shape, const Vec2& direction) {
+        return static_cast<const T*>(shape)->Support(direction);
+    }
+
+    const void* m_shape;
+    SupportFunc m_support;
+    Transform2D m_transform;
+    float m_radius;
+};
+
+/**
+ * @brief simplex a GJK query ended with, points are in the local space of
+ * each shape so it stays valid as the shapes move
+ */
+struct GjkSimplex {
+    static constexpr uint32_t MaxVertices = 3;
+
+    Vec2 m_localA[MaxVertices];
+    Vec2 m_localB[MaxVertices];
+    uint32_t m_count = 0;  // 0 starts the query cold
+};
+
+struct GjkResult {
+    Vec2 m_pointA;     // closest point on the core of A
+    Vec2 m_pointB;     // closest point on the core of B
+    float m_distance;  // between the cores, 0 if they overlap
+    uint32_t m_iterations;
+};
+
+/**
+ * @brief distance between the cores of a and b, radii are ignored
+ * @param simplex  in: simplex to start from, out: simplex of the result
+ */
+GjkResult GjkDistance(const ConvexProxy& a, const ConvexProxy& b,
+                      GjkSimplex& simplex);
+
+/**
+ * @brief penetration of overlapping cores, expands the simplex GjkDistance
+ * ended with
+ * @param normal  points from A to B
+ * @return false if the Minkowski difference has no area, like parallel
+ * segments
+ */
+bool EpaPenetration(const ConvexProxy& a, const ConvexProxy& b,
+                    const GjkSimplex& simplex, Vec2& normal, float& depth,
+                    Vec2& pointA, Vec2& pointB);
+
+/**
+ * @brief ray cast against any convex proxy by conservative advancement
+ * @param fraction  in: max fraction of the segment, out: hit fraction
+ * @note a ray starting inside doesn't hit
+ */
+bool ConvexRayCast(const ConvexProxy& proxy, const Vec2& from, const Vec2& to,
+                   float& fraction, Vec2& normal);
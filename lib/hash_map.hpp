@@ -0,0 +1,161 @@
+#pragma once
+#include "macro.hpp"
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief open addressing hash map with 64 bit keys, linear probing and
+ * backward shift deletion so no tombstones pile up
+ * @note values are stored inline, pointers to them are invalidated by Insert
+ * and Erase
+ */
+template <typename T>
+class OpenHashMap {
+public:
+    static constexpr uint64_t EmptyKey = UINT64_MAX;
+
+    T* Find(uint64_t key) {
+        RETURN_NULL_IF_FALSE(!m_keys.empty());
+        for (size_t i = slotOf(key);; i = next(i)) {
+            if (m_keys[i] == key) {
+                return &m_values[i];
+            }
+            RETURN_NULL_IF_FALSE(m_keys[i] != EmptyKey);
+        }
+    }
+
+    const T* Find(uint64_t key) const {
+        return const_cast<OpenHashMap*>(this)->Find(key);
+    }
+
+    /**
+     * @brief return the value of key, a default constructed one is inserted
+     * if key is missing
+     * @param inserted  set to true if the key was missing
+     */
+    T& Insert(uint64_t key, bool& inserted) {
+        assert(key != EmptyKey);
+        if ((m_size + 1) * 2 > m_keys.size()) {
+            rehash(m_keys.empty() ? 16 : m_keys.size() * 2);
+        }
+
+        size_t i = slotOf(key);
+        for (; m_keys[i] != EmptyKey; i = next(i)) {
+            if (m_keys[i] == key) {
+                inserted = false;
+                return m_values[i];
+            }
+        }
+        m_keys[i] = key;
+        m_values[i] = T{};
+        m_size++;
+        inserted = true;
+        return m_values[i];
+    }
+
+    bool Erase(uint64_t key) {
+        RETURN_FALSE_IF_FALSE(!m_keys.empty());
+        for (size_t i = slotOf(key);; i = next(i)) {
+            if (m_keys[i] == key) {
+                eraseAt(i);
+                return true;
+            }
+            RETURN_FALSE_IF_FALSE(m_keys[i] != EmptyKey);
+        }
+    }
+
+    /**
+     * @brief erase every entry for which pred(key, value) returns true
+     */
+    template <typename F>
+    void EraseIf(F&& pred) {
+        for (size_t i = 0; i < m_keys.size();) {
+            // a later entry may be shifted into i, so look at i again
+            if (m_keys[i] != EmptyKey && pred(m_keys[i], m_values[i])) {
+                eraseAt(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    template <typename F>
+    void ForEach(F&& f) {
+        for (size_t i = 0; i < m_keys.size(); ++i) {
+            CONTINUE_IF(m_keys[i] == EmptyKey);
+            f(m_keys[i], m_values[i]);
+        }
+    }
+
+    template <typename F>
+    void ForEach(F&& f) const {
+        for (size_t i = 0; i < m_keys.size(); ++i) {
+            CONTINUE_IF(m_keys[i] == EmptyKey);
+            f(m_keys[i], m_values[i]);
+        }
+    }
+
+    void Clear() {
+        m_keys.assign(m_keys.size(), EmptyKey);
+        m_size = 0;
+    }
+
+    size_t Size() const { return m_size; }
+
+    size_t Capacity() const { return m_keys.size(); }
+
+private:
+    std::vector<uint64_t> m_keys;
+    std::vector<T> m_values;
+    size_t m_size = 0;
+
+    static uint64_t hash(uint64_t key) {
+        // splitmix64 finalizer, pair keys are far from uniform
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ull;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebull;
+        key ^= key >> 31;
+        return key;
+    }
+
+    size_t slotOf(uint64_t key) const {
+        return hash(key) & (m_keys.size() - 1);
+    }
+
+    size_t next(size_t i) const { return (i + 1) & (m_keys.size() - 1); }
+
+    void rehash(size_t capacity) {
+        std::vector<uint64_t> keys(capacity, EmptyKey);
+        std::vector<T> values(capacity);
+        keys.swap(m_keys);
+        values.swap(m_values);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            CONTINUE_IF(keys[i] == EmptyKey);
+            size_t j = slotOf(keys[i]);
+            while (m_keys[j] != EmptyKey) {
+                j = next(j);
+            }
+            m_keys[j] = keys[i];
+            m_values[j] = std::move(values[i]);
+        }
+    }
+
+    void eraseAt(size_t i) {
+        // shift back following entries that probed past i
+        size_t hole = i;
+        for (size_t j = next(i); m_keys[j] != EmptyKey; j = next(j)) {
+            size_t home = slotOf(m_keys[j]);
+            // entry j may move to hole if its home is not in (hole, j]
+            bool between = hole <= j ? (hole < home && home <= j)
+                                     : (hole < home || home <= j);
+            CONTINUE_IF(between);
+            m_keys[hole] = m_keys[j];
+            m_values[hole] = std::move(m_values[j]);
+            hole = j;
+        }
+        m_keys[hole] = EmptyKey;
+        m_size--;
+    }
+};
@@ -0,0 +1,92 @@
+#include "island.hpp"
+
+#include "macro.hpp"
+#include <numeric>
+
+void UnionFind::Reset(size_t count) {
+    m_parents.resize(count);
+    std::iota(m_parents.begin(), m_parents.end(), 0u);
+    m_sizes.assign(count, 1);
+}
+
+uint32_t UnionFind::Find(uint32_t i) {
+    while (m_parents[i] != i) {
+        // path halving
+        m_parents[i] = m_parents[m_parents[i]];
+        i = m_parents[i];
+    }
+    return i;
+}
+
+void UnionFind::Union(uint32_t a, uint32_t b) {
+    a = Find(a);
+    b = Find(b);
+    RETURN_IF_FALSE(a != b);
+
+    if (m_sizes[a] < m_sizes[b]) {
+        std::swap(a, b);
+    }
+    m_parents[b] = a;
+    m_sizes[a] += m_sizes[b];
+}
+
+void IslandBuilder::Build(const BodyStorage& bodies,
+                          const std::vector<Manifold*>& manifolds) {
+    uint32_t count = static_cast<uint32_t>(bodies.Size());
+    const float* invMasses = bodies.m_invMasses.data();
+
+    m_unionFind.Reset(count);
+    for (Manifold* m : manifolds) {
+        uint32_t a = m->m_contacts[0].m_bodyA;
+        uint32_t b = m->m_contacts[0].m_bodyB;
+        CONTINUE_IF(invMasses[a] == 0 || invMasses[b] == 0);
+        m_unionFind.Union(a, b);
+    }
+
+    // number islands and count their bodies
+    m_islands.clear();
+    m_islandOfRoot.assign(count, BodyHandle::InvalidIndex);
+    for (uint32_t i = 0; i < count; ++i) {
+        CONTINUE_IF(invMasses[i] == 0 || !bodies.IsAwake(i));
+        uint32_t& island = m_islandOfRoot[m_unionFind.Find(i)];
+        if (island == BodyHandle::InvalidIndex) {
+            island = static_cast<uint32_t>(m_islands.size());
+            m_islands.push_back({0, 0, 0, 0});
+        }
+        m_islands[island].m_bodyCount++;
+    }
+
+    for (Manifold* m : manifolds) {
+        uint32_t a = m->m_contacts[0].m_bodyA;
+        uint32_t b = m->m_contacts[0].m_bodyB;
+        uint32_t body = invMasses[a] != 0 ? a : b;
+        m_islands[m_islandOfRoot[m_unionFind.Find(body)]].m_manifoldCount++;
+    }
+
+    uint32_t bodyStart = 0;
+    uint32_t manifoldStart = 0;
+    for (auto& island : m_islands) {
+        island.m_bodyStart = bodyStart;
+        island.m_manifoldStart = manifoldStart;
+        bodyStart += island.m_bodyCount;
+        manifoldStart += island.m_manifoldCount;
+        // counts are rebuilt while filling
+        island.m_bodyCount = 0;
+        island.m_manifoldCount = 0;
+    }
+
+    m_bodies.resize(bodyStart);
+    m_manifolds.resize(manifoldStart);
+    for (uint32_t i = 0; i < count; ++i) {
+        CONTINUE_IF(invMasses[i] == 0 || !bodies.IsAwake(i));
+        auto& island = m_islands[m_islandOfRoot[m_unionFind.Find(i)]];
+        m_bodies[island.m_bodyStart + island.m_bodyCount++] = i;
+    }
+    for (Manifold* m : manifolds) {
+        uint32_t a = m->m_contacts[0].m_bodyA;
+        uint32_t b = m->m_contacts[0].m_bodyB;
+        uint32_t body = invMasses[a] != 0 ? a : b;
+        auto& island = m_islands[m_islandOfRoot[m_unionFind.Find(body)]];
+        m_manifolds[island.m_manifoldStart + island.m_manifoldCount++] = m;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "body.hpp"
+#include "manifold.hpp"
+#include <cstdint>
+#include <vector>
+
+class UnionFind {
+public:
+    void Reset(size_t count);
+    uint32_t Find(uint32_t i);
+    void Union(uint32_t a, uint32_t b);
+
+private:
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_sizes;
+};
+
+/**
+ * @brief bodies and manifolds of one island, ranges in IslandBuilder arrays
+ */
+struct Island {
+    uint32_t m_bodyStart;
+    uint32_t m_bodyCount;
+    uint32_t m_manifoldStart;
+    uint32_t m_manifoldCount;
+};
+
+/**
+ * @brief group awake dynamic bodies connected by touching manifolds
+ * @note static bodies don't join islands, otherwise everything resting on
+ * the ground would be one island
+ */
+class IslandBuilder {
+public:
+    void Build(const BodyStorage& bodies,
+               const std::vector<Manifold*>& manifolds);
+
+    const std::vector<Island>& GetIslands() const { return m_islands; }
+
+    const uint32_t* GetBodies(const Island& island) const {
+        return m_bodies.data() + island.m_bodyStart;
+    }
+
+    Manifold* const* GetManifolds(const Island& island) const {
+        return m_manifolds.data() + island.m_manifoldStart;
+    }
+
+private:
+    UnionFind m_unionFind;
+    std::vector<uint32_t> m_islandOfRoot;
+    std::vector<Island> m_islands;
+    std::vector<uint32_t> m_bodies;       // grouped by island
+    std::vector<Manifold*> m_manifolds;   // grouped by island
+};
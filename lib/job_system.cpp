@@ -0,0 +1,112 @@
+#include "job_system.hpp"
+
+#include "macro.hpp"
+#include <algorithm>
+#include <cassert>
+
+JobSystem::JobSystem(uint32_t threadCount) : m_threadCount{threadCount} {
+    if (m_threadCount == 0) {
+        m_threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (uint32_t i = 0; i < m_threadCount; ++i) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (uint32_t i = 1; i < m_threadCount; ++i) {
+        m_workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock{m_wakeMutex};
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize,
+                            const RangeFunc& f) {
+    RETURN_IF_FALSE(count > 0);
+    grainSize = std::max(grainSize, 1u);
+
+    if (m_threadCount == 1 || count <= grainSize) {
+        for (uint32_t begin = 0; begin < count; begin += grainSize) {
+            f(begin, std::min(begin + grainSize, count), 0);
+        }
+        return;
+    }
+
+    assert(m_remaining == 0 && "ParallelFor is not reentrant");
+    uint32_t jobCount = (count + grainSize - 1) / grainSize;
+    m_remaining = jobCount;
+
+    // deal chunks out round robin, idle threads balance by stealing
+    for (uint32_t k = 0; k < jobCount; ++k) {
+        uint32_t begin = k * grainSize;
+        auto& queue = *m_queues[k % m_threadCount];
+        std::lock_guard<std::mutex> lock{queue.m_mutex};
+        queue.m_jobs.push_back({&f, begin, std::min(begin + grainSize, count)});
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_wakeMutex};
+        m_queued += jobCount;
+    }
+    m_wake.notify_all();
+
+    Job job;
+    while (m_remaining.load(std::memory_order_acquire) > 0) {
+        if (popOrSteal(0, job)) {
+            run(job, 0);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::popOrSteal(uint32_t thread, Job& job) {
+    {
+        auto& queue = *m_queues[thread];
+        std::lock_guard<std::mutex> lock{queue.m_mutex};
+        if (!queue.m_jobs.empty()) {
+            job = queue.m_jobs.back();
+            queue.m_jobs.pop_back();
+            m_queued--;
+            return true;
+        }
+    }
+
+    for (uint32_t i = 1; i < m_threadCount; ++i) {
+        auto& queue = *m_queues[(thread + i) % m_threadCount];
+        std::lock_guard<std::mutex> lock{queue.m_mutex};
+        CONTINUE_IF(queue.m_jobs.empty());
+        job = queue.m_jobs.front();
+        queue.m_jobs.pop_front();
+        m_queued--;
+        m_steals++;
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::run(const Job& job, uint32_t thread) {
+    (*job.m_func)(job.m_begin, job.m_end, thread);
+    m_remaining.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::workerLoop(uint32_t thread) {
+    Job job;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{m_wakeMutex};
+            m_wake.wait(lock, [this] { return m_queued > 0 || m_quit; });
+            RETURN_IF_FALSE(!m_quit);
+        }
+        while (popOrSteal(thread, job)) {
+            run(job, thread);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief fork-join thread pool with one job deque per thread, a thread pops
+ * its own jobs from the back and steals from the front of the others
+ * @note the calling thread is thread 0 and works on its jobs as well
+ */
+class JobSystem {
+public:
+    /**
+     * @brief called with the range [begin, end) and the index of the thread
+     * running it
+     */
+    using RangeFunc =
+        std::function<void(uint32_t begin, uint32_t end, uint32_t thread)>;
+
+    /**
+     * @param threadCount  threads including the caller, 0 means one per
+     * hardware thread
+     */
+    explicit JobSystem(uint32_t threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    uint32_t GetThreadCount() const { return m_threadCount; }
+
+    /**
+     * @brief run f over [0, count) split in chunks of grainSize and wait for
+     * all of them
+     * @note chunk k always covers [k * grainSize, (k + 1) * grainSize), so
+     * results written per chunk don't depend on scheduling. Must not be
+     * called from inside a job
+     */
+    void ParallelFor(uint32_t count, uint32_t grainSize, const RangeFunc& f);
+
+    // jobs run by a thread other than the one they were queued on
+    uint64_t GetStealCount() const { return m_steals; }
+
+private:
+    struct Job {
+        const RangeFunc* m_func;
+        uint32_t m_begin;
+        uint32_t m_end;
+    };
+
+    struct Queue {
+        std::mutex m_mutex;
+        std::deque<Job> m_jobs;
+    };
+
+    uint32_t m_threadCount;
+    std::vector<std::unique_ptr<Queue>> m_queues;  // thread -> its jobs
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<uint32_t> m_queued{0};     // jobs waiting in queues
+    std::atomic<uint32_t> m_remaining{0};  // jobs not finished yet
+    std::atomic<uint64_t> m_steals{0};
+    bool m_quit = false;
+
+    bool popOrSteal(uint32_t thread, Job& job);
+    void run(const Job& job, uint32_t thread);
+    void workerLoop(uint32_t thread);
+};
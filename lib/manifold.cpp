@@ -0,0 +1,77 @@
+#include "manifold.hpp"
+
+#include "macro.hpp"
+#include <algorithm>
+
+namespace {
+
+// contacts this close in both bodies' local space are the same contact
+constexpr float MatchDistance = 0.5f;
+
+}  // namespace
+
+uint64_t ManifoldCache::GetPairKey(uint32_t slotA, uint32_t slotB) {
+    if (slotA > slotB) {
+        std::swap(slotA, slotB);
+    }
+    return (static_cast<uint64_t>(slotA) << 32) | slotB;
+}
+
+Manifold& ManifoldCache::Add(const BodyStorage& bodies, uint32_t indexA,
+                             uint32_t indexB, const CollideCache& cache,
+                             const Contact* contacts, uint32_t count) {
+    assert(count <= Manifold::MaxContacts);
+    BodyHandle a = bodies.GetHandle(indexA);
+    BodyHandle b = bodies.GetHandle(indexB);
+
+    bool inserted = false;
+    Manifold& m =
+        m_manifolds.Insert(GetPairKey(a.m_index, b.m_index), inserted);
+
+    // a slot reused by a new body, or the pair seen in the other order
+    if (m.m_bodyA != a || m.m_bodyB != b) {
+        m.m_contactCount = 0;
+    }
+
+    float normalImpulses[Manifold::MaxContacts] = {};
+    float tangentImpulses[Manifold::MaxContacts] = {};
+    for (uint32_t i = 0; i < count; ++i) {
+        for (uint32_t j = 0; j < m.m_contactCount; ++j) {
+            const Contact& old = m.m_contacts[j];
+            CONTINUE_IF(LengthSqrd(contacts[i].m_ptOnALocalSpace -
+                                   old.m_ptOnALocalSpace) >
+                            MatchDistance * MatchDistance ||
+                        LengthSqrd(contacts[i].m_ptOnBLocalSpace -
+                                   old.m_ptOnBLocalSpace) >
+                            MatchDistance * MatchDistance);
+            normalImpulses[i] = m.m_normalImpulses[j];
+            tangentImpulses[i] = m.m_tangentImpulses[j];
+            break;
+        }
+    }
+
+    m.m_bodyA = a;
+    m.m_bodyB = b;
+    m.m_contactCount = count;
+    for (uint32_t i = 0; i < count; ++i) {
+        m.m_contacts[i] = contacts[i];
+        m.m_normalImpulses[i] = normalImpulses[i];
+        m.m_tangentImpulses[i] = tangentImpulses[i];
+    }
+    m.m_step = m_step;
+    m.m_cache = cache;
+    return m;
+}
+
+void ManifoldCache::EndStep() {
+    m_manifolds.EraseIf(
+        [&](uint64_t, const Manifold& m) { return m.m_step != m_step; });
+}
+
+const Manifold* ManifoldCache::Find(BodyHandle a, BodyHandle b) const {
+    const Manifold* m = m_manifolds.Find(GetPairKey(a.m_index, b.m_index));
+    RETURN_NULL_IF_FALSE(m);
+    RETURN_NULL_IF_FALSE((m->m_bodyA == a && m->m_bodyB == b) ||
+                         (m->m_bodyA == b && m->m_bodyB == a));
+    return m;
+}
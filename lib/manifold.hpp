@@ -0,0 +1,64 @@
+#pragma once
+#include "body.hpp"
+#include "contact.hpp"
+#include "hash_map.hpp"
+#include <cstdint>
+
+/**
+ * @brief contacts of one body pair, kept across steps
+ * @note pairs overlapping in the broadphase are kept with no contacts, so
+ * the narrowphase keeps its cache while they approach
+ */
+struct Manifold {
+    static constexpr uint32_t MaxContacts = MaxManifoldContacts;
+
+    BodyHandle m_bodyA;
+    BodyHandle m_bodyB;
+    Contact m_contacts[MaxContacts];
+    // accumulated by the solver
+    float m_normalImpulses[MaxContacts] = {};
+    float m_tangentImpulses[MaxContacts] = {};
+    uint32_t m_contactCount = 0;
+    uint32_t m_step = 0;  // last step the pair was tested
+    CollideCache m_cache;
+};
+
+/**
+ * @brief manifolds of body pairs keyed by ordered body slots
+ * @note a pair that is not tested in a step is evicted at its end
+ */
+class ManifoldCache {
+public:
+    static uint64_t GetPairKey(uint32_t slotA, uint32_t slotB);
+
+    void BeginStep() { m_step++; }
+
+    /**
+     * @brief store the contacts found for bodies a and b this step, a contact
+     * close to an old one in the local space of both bodies keeps its
+     * impulses
+     */
+    Manifold& Add(const BodyStorage& bodies, uint32_t a, uint32_t b,
+                  const CollideCache& cache, const Contact* contacts,
+                  uint32_t count);
+
+    /**
+     * @brief evict pairs that were not tested in this step
+     */
+    void EndStep();
+
+    const Manifold* Find(BodyHandle a, BodyHandle b) const;
+
+    template <typename F>
+    void ForEach(F&& f) {
+        m_manifolds.ForEach([&](uint64_t, Manifold& m) { f(m); });
+    }
+
+    size_t Size() const { return m_manifolds.Size(); }
+
+    void Clear() { m_manifolds.Clear(); }
+
+private:
+    OpenHashMap<Manifold> m_manifolds;
+    uint32_t m_step = 0;
+};
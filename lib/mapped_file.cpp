@@ -0,0 +1,76 @@
+#include "mapped_file.hpp"
+
+#include "macro.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::shared_ptr<const MappedFile> MappedFile::Open(const char* path) {
+    std::shared_ptr<MappedFile> file{new MappedFile};
+    file->m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    RETURN_NULL_IF_FALSE(file->m_file != INVALID_HANDLE_VALUE);
+
+    LARGE_INTEGER size;
+    RETURN_NULL_IF_FALSE(GetFileSizeEx(file->m_file, &size) &&
+                         size.QuadPart > 0);
+    file->m_size = static_cast<size_t>(size.QuadPart);
+
+    file->m_mapping = CreateFileMappingA(file->m_file, nullptr, PAGE_READONLY,
+                                         0, 0, nullptr);
+    RETURN_NULL_IF_FALSE(file->m_mapping);
+    file->m_data = MapViewOfFile(file->m_mapping, FILE_MAP_READ, 0, 0, 0);
+    RETURN_NULL_IF_FALSE(file->m_data);
+    return file;
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file && m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+    }
+}
+
+#else
+
+std::shared_ptr<const MappedFile> MappedFile::Open(const char* path) {
+    int fd = open(path, O_RDONLY);
+    RETURN_NULL_IF_FALSE(fd >= 0);
+
+    // the mapping stays valid after the descriptor is closed
+    std::shared_ptr<MappedFile> file{new MappedFile};
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size),
+                          PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            file->m_data = data;
+            file->m_size = static_cast<size_t>(info.st_size);
+        }
+    }
+    close(fd);
+    RETURN_NULL_IF_FALSE(file->m_data);
+    return file;
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) {
+        munmap(const_cast<void*>(m_data), m_size);
+    }
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief read only memory map of a whole file
+ * @note shared so data pointing into the mapping can keep it alive
+ */
+class MappedFile {
+public:
+    /**
+     * @return null if the file can't be opened or mapped
+     */
+    static std::shared_ptr<const MappedFile> Open(const char* path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    MappedFile() = default;
+
+    const void* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;  // HANDLE
+    void* m_mapping = nullptr;
+#endif
+};
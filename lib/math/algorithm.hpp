@@ -1,70 +1,20 @@
 #pragma once
 
 #include "math/constants.hpp"
+#include "math/expression.hpp"
+#include "math/factorization.hpp"
+#include "math/gemm.hpp"
 #include "math/matrix.hpp"
 #include "math/view.hpp"
 #include <iostream>
 #include <optional>
 #include <utility>
 
-template <typename T, bool IsConst>
-auto operator+(MatrixView<T, IsConst> m1, MatrixView<T, IsConst> m2) noexcept {
-    assert(m1.RowNum() == m2.RowNum());
-    assert(m1.ColNum() == m2.ColNum());
-    Matrix m(m1.ColNum(), m1.RowNum());
-    for (int c = 0; c < m1.ColNum(); c++) {
-        for (int r = 0; r < m2.RowNum(); r++) {
-            m[c][r] = m1[c][r] + m2[c][r];
-        }
-    }
-    return m;
-}
-
-template <typename T, bool IsConst>
-auto operator-(MatrixView<T, IsConst> m1, MatrixView<T, IsConst> m2) noexcept {
-    assert(m1.RowNum() == m2.RowNum());
-    assert(m1.ColNum() == m2.ColNum());
-    Matrix m(m1.ColNum(), m1.RowNum());
-    for (int c = 0; c < m1.ColNum(); c++) {
-        for (int r = 0; r < m2.RowNum(); r++) {
-            m[c][r] = m1[c][r] - m2[c][r];
-        }
-    }
-    return m;
-}
-
-template <typename T, bool IsConst>
-auto operator*(MatrixView<T, IsConst> m1, double value) noexcept {
-    Matrix m(m1.ColNum(), m1.RowNum());
-    for (int c = 0; c < m1.ColNum(); c++) {
-        for (int r = 0; r < m1.RowNum(); r++) {
-            m[c][r] = m1[c][r] * value;
-        }
-    }
-    return m;
-}
-
-template <typename T, bool IsConst>
-auto operator*(double value, MatrixView<T, IsConst> m1) noexcept {
-    return m1 * value;
-}
-
-template <typename T, bool IsConst>
-auto operator/(MatrixView<T, IsConst> m1, double value) noexcept {
-    Matrix m(m1.ColNum(), m1.RowNum());
-    for (int c = 0; c < m1.ColNum(); c++) {
-        for (int r = 0; r < m1.RowNum(); r++) {
-            m[c][r] = m1[c][r] / value;
-        }
-    }
-    return m;
-}
-
 template <typename T, bool IsConst>
 std::ostream& operator<<(std::ostream& o, MatrixView<T, IsConst> view) {
     o << "[";
-    for (int r = 0; r < view.RowNum(); r++) {
-        for (int c = 0; c < view.ColNum(); c++) {
+    for (size_t r = 0; r < view.RowNum(); r++) {
+        for (size_t c = 0; c < view.ColNum(); c++) {
             o << view[c][r] << " ";
         }
         o << std::endl;
@@ -75,6 +25,7 @@ std::ostream& operator<<(std::ostream& o, MatrixView<T, IsConst> view) {
 
 //
 // @brief A_m_n x B_n_r
+// @note float and double go through the blocked Gemm, which sums in T
 //
 template <typename T, bool IsConst>
 auto operator*(MatrixView<T, IsConst> m1, MatrixView<T, IsConst> m2) {
@@ -83,10 +34,15 @@ auto operator*(MatrixView<T, IsConst> m1, MatrixView<T, IsConst> m2) {
     auto N = m1.ColNum();
     auto R = m2.ColNum();
     Matrix<T> mat(R, M);
-    for (int m = 0; m < M; m++) {
-        for (int r = 0; r < R; r++) {
+    if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+        Gemm(MatrixView<T, true>{m1}, MatrixView<T, true>{m2},
+             MatrixView<T, false>{mat});
+        return mat;
+    }
+    for (size_t m = 0; m < M; m++) {
+        for (size_t r = 0; r < R; r++) {
             double sum = 0;
-            for (int n = 0; n < N; n++) {
+            for (size_t n = 0; n < N; n++) {
                 sum += m1[n][m] * m2[r][n];
             }
             mat[r][m] = sum;
@@ -97,10 +53,10 @@ auto operator*(MatrixView<T, IsConst> m1, MatrixView<T, IsConst> m2) {
 
 template <typename T, bool IsConst>
 auto MulEach(MatrixView<T, IsConst> m1, MatrixView<T, IsConst> m2) {
-    asset(m1.ColNum() == m2.ColNum() && m1.RowNum() == m2.RowNum());
+    assert(m1.ColNum() == m2.ColNum() && m1.RowNum() == m2.RowNum());
     Matrix<T> m(m1.ColNum(), m2.RowNum());
-    for (int c = 0; c < m1.ColNum(); c++) {
-        for (int r = 0; r < m1.RowNum(); r++) {
+    for (size_t c = 0; c < m1.ColNum(); c++) {
+        for (size_t r = 0; r < m1.RowNum(); r++) {
             m[c][r] = m1[c][r] * m2[c][r];
         }
     }
@@ -109,10 +65,10 @@ auto MulEach(MatrixView<T, IsConst> m1, MatrixView<T, IsConst> m2) {
 
 template <typename T, bool IsConst>
 auto DivEach(MatrixView<T, IsConst> m1, MatrixView<T, IsConst> m2) {
-    asset(m1.ColNum() == m2.ColNum() && m1.RowNum() == m2.RowNum());
+    assert(m1.ColNum() == m2.ColNum() && m1.RowNum() == m2.RowNum());
     Matrix<T> m(m1.ColNum(), m2.RowNum());
-    for (int c = 0; c < m1.ColNum(); c++) {
-        for (int r = 0; r < m1.RowNum(); r++) {
+    for (size_t c = 0; c < m1.ColNum(); c++) {
+        for (size_t r = 0; r < m1.RowNum(); r++) {
             m[c][r] = m1[c][r] / m2[c][r];
         }
     }
@@ -121,15 +77,18 @@ auto DivEach(MatrixView<T, IsConst> m1, MatrixView<T, IsConst> m2) {
 
 template <typename T, bool IsConst = true>
 auto Transpose(MatrixView<T, IsConst> m) {
-    Matrix mat(m.RowNum(), m.ColNum());
-    for (int c = 0; c < m.ColNum(); c++) {
-        for (int r = 0; r < m.RowNum(); r++) {
+    Matrix<T> mat(m.RowNum(), m.ColNum());
+    for (size_t c = 0; c < m.ColNum(); c++) {
+        for (size_t r = 0; r < m.RowNum(); r++) {
             mat[r][c] = m[c][r];
         }
     }
     return mat;
 }
 
+/**
+ * @brief closed forms up to 3x3, LU factorization of a copy above
+ */
 template <typename T, bool IsConst = true>
 double Det(MatrixView<T, IsConst> m) {
     assert(m.IsSquare());
@@ -147,26 +106,17 @@ double Det(MatrixView<T, IsConst> m) {
                 m[0][0] * m[2][1] * m[1][2]);
     }
 
-    double result = 0;
-    for (int c = 0; c < len; c++) {
-        Matrix<T> temp(len - 1, len - 1);
-        for (int idx = 0; idx < len; idx++) {
-            if (idx == c) continue;
-            for (int r = 1; r < len; r++) {
-                temp[idx < c ? idx : idx - 1][r - 1] = m[idx][r];
-            }
-        }
-        result += ((c % 2 == 0) ? 1 : -1) * m[c][0] * Det(MatrixView{temp});
-    }
-    return result;
+    Matrix<T> lu = MatrixView<T, true>{m}.Clone();
+    LUPivots pivots = LUDecompose(MatrixView<T, false>{lu});
+    return LUDet(MatrixView<T, true>{lu}, pivots);
 }
 
 template <typename T, bool IsConst = true>
 auto Cofactor(MatrixView<T, IsConst> m, size_t col, size_t row) {
     Matrix<T> mat(m.ColNum() - 1, m.RowNum() - 1);
-    for (int c = 0; c < m.ColNum(); c++) {
+    for (size_t c = 0; c < m.ColNum(); c++) {
         if (c == col) continue;
-        for (int r = 0; r < m.RowNum(); r++) {
+        for (size_t r = 0; r < m.RowNum(); r++) {
             if (r == row) continue;
             mat[c < col ? c : c - 1][r < row ? r : r - 1] = m[c][r];
         }
@@ -176,9 +126,9 @@ auto Cofactor(MatrixView<T, IsConst> m, size_t col, size_t row) {
 
 template <typename T, bool IsConst = true>
 auto Adjoint(MatrixView<T, IsConst> m) {
-    Matrix mat(m.ColNum(), m.RowNum());
-    for (int c = 0; c < m.ColNum(); c++) {
-        for (int r = 0; r < m.RowNum(); r++) {
+    Matrix<T> mat(m.ColNum(), m.RowNum());
+    for (size_t c = 0; c < m.ColNum(); c++) {
+        for (size_t r = 0; r < m.RowNum(); r++) {
             mat[c][r] = (((c + r) % 2 == 0) ? 1 : -1) * Det(Cofactor(m, c, r));
         }
     }
@@ -190,7 +140,10 @@ auto Adjoint(MatrixView<T, IsConst> m) {
  */
 template <typename T, bool IsConst>
 auto Inverse(MatrixView<T, IsConst> m) {
-    return Adjoint(m) / Det(m);
+    assert(m.IsSquare());
+    Matrix<T> lu = MatrixView<T, true>{m}.Clone();
+    LUPivots pivots = LUDecompose(MatrixView<T, false>{lu});
+    return LUInverse(MatrixView<T, true>{lu}, pivots);
 }
 
 enum class ReducedRowEchelonFormPolicy {
@@ -201,23 +154,26 @@ enum class ReducedRowEchelonFormPolicy {
 template <typename T>
 void RowEchelonForm(MatrixView<T, false> m) {
     size_t minNum = std::min(m.RowNum(), m.ColNum());
-    for (int i = 0; i < minNum; i++) {
+    for (size_t i = 0; i < minNum; i++) {
         // rearrange
         size_t swapRow = i;
-        for (int r = i + 1; r < m.RowNum(); r++) {
-            if (std::abs(m[i][i]) < std::abs(m[i][r])) {
+        for (size_t r = i + 1; r < m.RowNum(); r++) {
+            if (std::abs(m[i][swapRow]) < std::abs(m[i][r])) {
                 swapRow = r;
             }
         }
 
-        for (int c = 0; c < m.ColNum(); c++) {
+        for (size_t c = 0; c < m.ColNum(); c++) {
             std::swap(m[c][i], m[c][swapRow]);
         }
 
         // gaussian elimination
-        for (int r = i + 1; r < m.RowNum(); r++) {
+        // the eliminated entry is set to an exact zero, rounding would leave
+        // a tiny value that ReducedRowEchelonForm takes as a leading entry
+        for (size_t r = i + 1; r < m.RowNum(); r++) {
             double value = m[i][r] / m[i][i];
-            for (int k = i; k < m.ColNum(); k++) {
+            m[i][r] = 0;
+            for (size_t k = i + 1; k < m.ColNum(); k++) {
                 m[k][r] -= value * m[k][i];
             }
         }
@@ -231,8 +187,8 @@ void RowEchelonForm(MatrixView<T, false> m) {
 template <typename T>
 bool ReducedRowEchelonForm(MatrixView<T, false> m,
                            ReducedRowEchelonFormPolicy policy) {
-    for (int r = m.RowNum() - 1; r >= 0; r--) {
-        int lastNozeroIdx = 0;
+    for (size_t r = m.RowNum(); r-- > 0;) {
+        size_t lastNozeroIdx = 0;
         while (lastNozeroIdx < m.ColNum() && m[lastNozeroIdx][r] == 0) {
             lastNozeroIdx++;
         }
@@ -243,14 +199,14 @@ bool ReducedRowEchelonForm(MatrixView<T, false> m,
             continue;
         }
 
-        for (int nr = r - 1; nr >= 0; nr--) {
+        for (size_t nr = r; nr-- > 0;) {
             double value = m[lastNozeroIdx][nr] / m[lastNozeroIdx][r];
-            for (int c = lastNozeroIdx; c < m.ColNum(); c++) {
+            for (size_t c = lastNozeroIdx; c < m.ColNum(); c++) {
                 m[c][nr] -= value * m[c][r];
             }
         }
         double fstNozeroElem = m[lastNozeroIdx][r];
-        for (int c = lastNozeroIdx; c < m.ColNum(); c++) {
+        for (size_t c = lastNozeroIdx; c < m.ColNum(); c++) {
             m[c][r] /= fstNozeroElem;
         }
     }
@@ -274,7 +230,7 @@ std::optional<Matrix<T>> Solve(MatrixView<T, false> m) {
     }
 
     Matrix<T> result{1, m.RowNum()};
-    for (int i = 0; i < m.RowNum(); i++) {
+    for (size_t i = 0; i < m.RowNum(); i++) {
         result[0][i] = m[m.ColNum() - 1][i];
     }
     return result;
@@ -292,31 +248,6 @@ std::optional<Matrix<T>> Solve(MatrixView<T, true> m) {
 
 // wrappers
 
-template <typename T>
-Matrix<T> operator+(const Matrix<T>& m1, const Matrix<T>& m2) noexcept {
-    return MatrixView(m1) + MatrixView(m2);
-}
-
-template <typename T>
-Matrix<T> operator-(const Matrix<T>& m1, const Matrix<T>& m2) noexcept {
-    return MatrixView(m1) - MatrixView(m2);
-}
-
-template <typename T>
-Matrix<T> operator*(const Matrix<T>& m1, double value) noexcept {
-    return MatrixView(m1) * value;
-}
-
-template <typename T>
-Matrix<T> operator*(double value, const Matrix<T>& m1) noexcept {
-    return m1 * value;
-}
-
-template <typename T>
-Matrix<T> operator/(const Matrix<T>& m1, double value) noexcept {
-    return MatrixView(m1) / value;
-}
-
 template <typename T>
 Matrix<T> operator*(const Matrix<T>& m1, const Matrix<T>& m2) {
     return MatrixView{m1} * MatrixView{m2};
@@ -358,7 +289,7 @@ std::ostream& operator<<(std::ostream& o, const Matrix<T>& view) {
 template <typename T, size_t Len>
 T Dot(const SVector<T, Len>& v1, const SVector<T, Len>& v2) {
     T sum = {};
-    for (int i = 0; i < Len; i++) {
+    for (size_t i = 0; i < Len; i++) {
         sum += v1[i] * v2[i];
     }
     return sum;
@@ -379,6 +310,14 @@ T Cross(const SVector<T, 2>& v1, const SVector<T, 2>& v2) {
     return v1.x * v2.y - v1.y * v2.x;
 }
 
+/**
+ * @brief cross product of s as a vector along the z axis with v: s x v
+ */
+template <typename T>
+SVector<T, 2> Cross(T s, const SVector<T, 2>& v) {
+    return SVector<T, 2>{-s * v.y, s * v.x};
+}
+
 template <typename T>
 SVector<T, 3> Cross(const SVector<T, 3>& v1, const SVector<T, 3>& v2) {
     SVector<T, 3> result;
@@ -0,0 +1,57 @@
+#include "math/arena.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// enough for aligned SIMD loads of float and double
+constexpr size_t ArenaAlignment = 32;
+
+size_t AlignUp(size_t value) {
+    return (value + ArenaAlignment - 1) & ~(ArenaAlignment - 1);
+}
+
+}  // namespace
+
+thread_local MatrixArena* MatrixArena::s_current = nullptr;
+
+MatrixArena::MatrixArena(size_t blockSize) {
+    m_blocks.push_back(
+        {std::make_unique<std::byte[]>(blockSize + ArenaAlignment),
+         blockSize});
+    m_capacity = blockSize;
+}
+
+void* MatrixArena::Allocate(size_t bytes) {
+    bytes = AlignUp(bytes);
+    if (m_offset + bytes > m_blocks.back().m_size) {
+        size_t size = std::max(bytes, m_blocks.back().m_size * 2);
+        m_blocks.push_back(
+            {std::make_unique<std::byte[]>(size + ArenaAlignment), size});
+        m_capacity += size;
+        m_offset = 0;
+    }
+
+    std::byte* base = m_blocks.back().m_memory.get();
+    auto aligned = AlignUp(reinterpret_cast<uintptr_t>(base));
+    void* result = reinterpret_cast<std::byte*>(aligned) + m_offset;
+    m_offset += bytes;
+    m_used += bytes;
+    return result;
+}
+
+void MatrixArena::Reset() {
+    if (m_blocks.size() > 1) {
+        m_blocks.clear();
+        m_blocks.push_back(
+            {std::make_unique<std::byte[]>(m_capacity + ArenaAlignment),
+             m_capacity});
+    }
+    m_offset = 0;
+    m_peak = m_used;
+    m_used = 0;
+}
+
+MatrixArena* MatrixArena::Current() {
+    return s_current;
+}
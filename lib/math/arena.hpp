@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief bump allocator for short lived matrices: an allocation moves a
+ * pointer, nothing is freed until Reset, which drops everything at once
+ * @note not thread safe, use one per thread. Memory outlives Reset, so
+ * after the first few resets it runs in one block without touching the
+ * global allocator
+ */
+class MatrixArena {
+public:
+    explicit MatrixArena(size_t blockSize = 64 * 1024);
+
+    MatrixArena(const MatrixArena&) = delete;
+    MatrixArena& operator=(const MatrixArena&) = delete;
+
+    void* Allocate(size_t bytes);
+
+    template <typename T>
+    T* Allocate(size_t count) {
+        return static_cast<T*>(Allocate(sizeof(T) * count));
+    }
+
+    /**
+     * @brief every allocation is invalid afterwards, blocks that overflowed
+     * since the last reset are merged into one big enough for all of them
+     */
+    void Reset();
+
+    // bytes handed out since the last Reset, it only grows until then
+    size_t GetUsedBytes() const { return m_used; }
+    // bytes handed out between the last two Resets
+    size_t GetPeakBytes() const { return m_peak; }
+    size_t GetCapacityBytes() const { return m_capacity; }
+
+    /**
+     * @brief arena the Matrix constructors of this thread allocate from,
+     * nullptr for the global allocator
+     */
+    static MatrixArena* Current();
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> m_memory;
+        size_t m_size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_offset = 0;  // into the last block
+    size_t m_used = 0;
+    size_t m_peak = 0;
+    size_t m_capacity = 0;
+
+    static thread_local MatrixArena* s_current;
+
+    friend class MatrixArenaScope;
+};
+
+/**
+ * @brief makes arena the current one of this thread until the scope ends
+ */
+class MatrixArenaScope {
+public:
+    explicit MatrixArenaScope(MatrixArena* arena)
+        : m_previous{MatrixArena::s_current} {
+        MatrixArena::s_current = arena;
+    }
+
+    ~MatrixArenaScope() { MatrixArena::s_current = m_previous; }
+
+    MatrixArenaScope(const MatrixArenaScope&) = delete;
+    MatrixArenaScope& operator=(const MatrixArenaScope&) = delete;
+
+private:
+    MatrixArena* m_previous;
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "math/matrix.hpp"
+#include "math/view.hpp"
+#include <type_traits>
+#include <utility>
+
+// element-wise +, -, * scalar and / scalar on Matrix and MatrixView build
+// lazy expressions instead of matrices. A whole chain runs as one loop
+// when it's assigned into a Matrix or a non-const MatrixView, which is also
+// the only allocation: Matrix<T> r = a * 2 - b + c;
+//
+// every element only reads its own position, so the destination may appear
+// in the expression, but not as a view shifted against it
+//
+// operands are referenced, keep expressions in one statement and don't
+// hold them in `auto` past it. Temporary matrices are moved into the
+// expression, so (a * b) + c is fine
+
+struct MatrixExprBase {};
+
+template <typename T>
+class MatrixLeaf : public MatrixExprBase {
+public:
+    using ElemType = T;
+
+    template <bool IsConst>
+    MatrixLeaf(MatrixView<T, IsConst> view)
+        : datas_{view.ColNum() > 0 ? view[0].Ptr() : nullptr},
+          stride_{view.ColStride()},
+          col_{view.ColNum()},
+          row_{view.RowNum()} {}
+
+    MatrixLeaf(const Matrix<T>& m)
+        : datas_{m.Ptr()},
+          stride_{m.RowNum()},
+          col_{m.ColNum()},
+          row_{m.RowNum()} {}
+
+    size_t ColNum() const noexcept { return col_; }
+    size_t RowNum() const noexcept { return row_; }
+
+    T Elem(size_t col, size_t row) const noexcept {
+        return datas_[col * stride_ + row];
+    }
+
+private:
+    const T* datas_;
+    size_t stride_;
+    size_t col_, row_;
+};
+
+// a temporary matrix moved into the expression that reads it
+template <typename T>
+class MatrixOwned : public MatrixExprBase {
+public:
+    using ElemType = T;
+
+    explicit MatrixOwned(Matrix<T>&& m) : matrix_{std::move(m)} {}
+
+    size_t ColNum() const noexcept { return matrix_.ColNum(); }
+    size_t RowNum() const noexcept { return matrix_.RowNum(); }
+
+    T Elem(size_t col, size_t row) const noexcept {
+        return matrix_.Ptr()[col * matrix_.RowNum() + row];
+    }
+
+private:
+    Matrix<T> matrix_;
+};
+
+template <typename L, typename R, typename Op>
+class MatrixBinary : public MatrixExprBase {
+public:
+    using ElemType = typename L::ElemType;
+
+    MatrixBinary(L l, R r) : l_{std::move(l)}, r_{std::move(r)} {
+        assert(l_.ColNum() == r_.ColNum() && l_.RowNum() == r_.RowNum());
+    }
+
+    size_t ColNum() const noexcept { return l_.ColNum(); }
+    size_t RowNum() const noexcept { return l_.RowNum(); }
+
+    ElemType Elem(size_t col, size_t row) const noexcept {
+        return Op::Apply(l_.Elem(col, row), r_.Elem(col, row));
+    }
+
+private:
+    L l_;
+    R r_;
+};
+
+template <typename E, typename Op>
+class MatrixScalar : public MatrixExprBase {
+public:
+    using ElemType = typename E::ElemType;
+
+    MatrixScalar(E e, ElemType value) : e_{std::move(e)}, value_{value} {}
+
+    size_t ColNum() const noexcept { return e_.ColNum(); }
+    size_t RowNum() const noexcept { return e_.RowNum(); }
+
+    ElemType Elem(size_t col, size_t row) const noexcept {
+        return Op::Apply(e_.Elem(col, row), value_);
+    }
+
+private:
+    E e_;
+    ElemType value_;
+};
+
+struct AddOp {
+    template <typename T>
+    static T Apply(T a, T b) noexcept { return a + b; }
+};
+
+struct SubOp {
+    template <typename T>
+    static T Apply(T a, T b) noexcept { return a - b; }
+};
+
+struct MulOp {
+    template <typename T>
+    static T Apply(T a, T b) noexcept { return a * b; }
+};
+
+struct DivOp {
+    template <typename T>
+    static T Apply(T a, T b) noexcept { return a / b; }
+};
+
+// operands of the element-wise operators
+
+template <typename X>
+struct IsMatrixOperand
+    : std::bool_constant<std::is_base_of_v<MatrixExprBase, X>> {};
+
+template <typename T>
+struct IsMatrixOperand<Matrix<T>> : std::true_type {};
+
+template <typename T, bool IsConst>
+struct IsMatrixOperand<MatrixView<T, IsConst>> : std::true_type {};
+
+template <typename X>
+concept MatrixOperand = IsMatrixOperand<std::remove_cvref_t<X>>::value;
+
+template <typename X>
+struct IsMatrix : std::false_type {};
+
+template <typename T>
+struct IsMatrix<Matrix<T>> : std::true_type {};
+
+template <typename X>
+auto ToMatrixExpr(X&& x) {
+    using Type = std::remove_cvref_t<X>;
+    if constexpr (std::is_base_of_v<MatrixExprBase, Type>) {
+        return Type{std::forward<X>(x)};
+    } else if constexpr (IsMatrix<Type>::value &&
+                         !std::is_lvalue_reference_v<X>) {
+        return MatrixOwned<typename Type::ElemType>{std::move(x)};
+    } else {
+        return MatrixLeaf<typename Type::ElemType>{x};
+    }
+}
+
+template <MatrixOperand A, MatrixOperand B>
+auto operator+(A&& a, B&& b) {
+    auto l = ToMatrixExpr(std::forward<A>(a));
+    auto r = ToMatrixExpr(std::forward<B>(b));
+    return MatrixBinary<decltype(l), decltype(r), AddOp>{std::move(l),
+                                                         std::move(r)};
+}
+
+template <MatrixOperand A, MatrixOperand B>
+auto operator-(A&& a, B&& b) {
+    auto l = ToMatrixExpr(std::forward<A>(a));
+    auto r = ToMatrixExpr(std::forward<B>(b));
+    return MatrixBinary<decltype(l), decltype(r), SubOp>{std::move(l),
+                                                         std::move(r)};
+}
+
+template <MatrixOperand A>
+auto operator*(A&& a, double value) {
+    auto e = ToMatrixExpr(std::forward<A>(a));
+    using ElemType = typename decltype(e)::ElemType;
+    return MatrixScalar<decltype(e), MulOp>{std::move(e),
+                                            static_cast<ElemType>(value)};
+}
+
+template <MatrixOperand A>
+auto operator*(double value, A&& a) {
+    return std::forward<A>(a) * value;
+}
+
+template <MatrixOperand A>
+auto operator/(A&& a, double value) {
+    auto e = ToMatrixExpr(std::forward<A>(a));
+    using ElemType = typename decltype(e)::ElemType;
+    return MatrixScalar<decltype(e), DivOp>{std::move(e),
+                                            static_cast<ElemType>(value)};
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "math/matrix.hpp"
+#include "math/view.hpp"
+#include <cmath>
+#include <vector>
+
+// factorizations work in place on a square view and keep the inner loops on
+// contiguous columns, solve/det/inverse reuse one factorization
+
+/**
+ * @brief row swaps of an LU factorization, row i was swapped with rows[i]
+ */
+struct LUPivots {
+    std::vector<size_t> rows;
+    int sign = 1;           // of the permutation, for the determinant
+    bool singular = false;  // a column had no nonzero pivot
+};
+
+/**
+ * @brief LU factorization with partial pivoting: P * m = L * U
+ * @note L has a unit diagonal and goes below the diagonal of m, U on and
+ * above it
+ */
+template <typename T>
+LUPivots LUDecompose(MatrixView<T, false> m) {
+    assert(m.IsSquare());
+    size_t n = m.RowNum();
+    LUPivots pivots;
+    pivots.rows.resize(n);
+    for (size_t k = 0; k < n; k++) {
+        T* colK = m[k].Ptr();
+        size_t pivot = k;
+        for (size_t r = k + 1; r < n; r++) {
+            if (std::abs(colK[r]) > std::abs(colK[pivot])) {
+                pivot = r;
+            }
+        }
+        pivots.rows[k] = pivot;
+        if (pivot != k) {
+            pivots.sign = -pivots.sign;
+            for (size_t c = 0; c < n; c++) {
+                T* col = m[c].Ptr();
+                std::swap(col[k], col[pivot]);
+            }
+        }
+        if (colK[k] == 0) {
+            pivots.singular = true;
+            continue;
+        }
+
+        T inv = T(1) / colK[k];
+        for (size_t r = k + 1; r < n; r++) {
+            colK[r] *= inv;
+        }
+        for (size_t c = k + 1; c < n; c++) {
+            T* col = m[c].Ptr();
+            T factor = col[k];
+            if (factor == 0) continue;
+            for (size_t r = k + 1; r < n; r++) {
+                col[r] -= colK[r] * factor;
+            }
+        }
+    }
+    return pivots;
+}
+
+/**
+ * @brief solve lu * x = b for every column of b, x is written over b
+ * @note lu must not be singular
+ */
+template <typename T>
+void LUSolve(MatrixView<T, true> lu, const LUPivots& pivots,
+             MatrixView<T, false> b) {
+    size_t n = lu.RowNum();
+    assert(b.RowNum() == n);
+    for (size_t c = 0; c < b.ColNum(); c++) {
+        T* x = b[c].Ptr();
+        for (size_t k = 0; k < n; k++) {
+            std::swap(x[k], x[pivots.rows[k]]);
+        }
+        for (size_t k = 0; k < n; k++) {
+            const T* colK = lu[k].Ptr();
+            T value = x[k];
+            if (value == 0) continue;
+            for (size_t r = k + 1; r < n; r++) {
+                x[r] -= colK[r] * value;
+            }
+        }
+        for (size_t k = n; k-- > 0;) {
+            const T* colK = lu[k].Ptr();
+            x[k] /= colK[k];
+            T value = x[k];
+            for (size_t r = 0; r < k; r++) {
+                x[r] -= colK[r] * value;
+            }
+        }
+    }
+}
+
+template <typename T>
+double LUDet(MatrixView<T, true> lu, const LUPivots& pivots) {
+    double det = pivots.sign;
+    for (size_t k = 0; k < lu.RowNum(); k++) {
+        det *= lu[k][k];
+    }
+    return det;
+}
+
+template <typename T>
+Matrix<T> LUInverse(MatrixView<T, true> lu, const LUPivots& pivots) {
+    Matrix<T> inv = Matrix<T>::Identity(lu.ColNum(), lu.RowNum());
+    LUSolve(lu, pivots, MatrixView<T, false>{inv});
+    return inv;
+}
+
+/**
+ * @brief Cholesky factorization of a symmetric positive definite m:
+ * m = L * L^T
+ * @note only the lower triangle of m is read, L is written over it and the
+ * upper triangle is left alone
+ * @return false if m is not positive definite
+ */
+template <typename T>
+bool CholeskyDecompose(MatrixView<T, false> m) {
+    assert(m.IsSquare());
+    size_t n = m.RowNum();
+    for (size_t k = 0; k < n; k++) {
+        T* colK = m[k].Ptr();
+        if (!(colK[k] > 0)) {
+            return false;
+        }
+        T diag = std::sqrt(colK[k]);
+        colK[k] = diag;
+        T inv = T(1) / diag;
+        for (size_t r = k + 1; r < n; r++) {
+            colK[r] *= inv;
+        }
+        for (size_t c = k + 1; c < n; c++) {
+            T* col = m[c].Ptr();
+            T factor = colK[c];
+            for (size_t r = c; r < n; r++) {
+                col[r] -= colK[r] * factor;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief solve L * L^T * x = b for every column of b, x is written over b
+ */
+template <typename T>
+void CholeskySolve(MatrixView<T, true> l, MatrixView<T, false> b) {
+    size_t n = l.RowNum();
+    assert(b.RowNum() == n);
+    for (size_t c = 0; c < b.ColNum(); c++) {
+        T* x = b[c].Ptr();
+        for (size_t k = 0; k < n; k++) {
+            const T* colK = l[k].Ptr();
+            x[k] /= colK[k];
+            T value = x[k];
+            for (size_t r = k + 1; r < n; r++) {
+                x[r] -= colK[r] * value;
+            }
+        }
+        for (size_t k = n; k-- > 0;) {
+            const T* colK = l[k].Ptr();
+            T sum = x[k];
+            for (size_t r = k + 1; r < n; r++) {
+                sum -= colK[r] * x[r];
+            }
+            x[k] = sum / colK[k];
+        }
+    }
+}
+
+template <typename T>
+double CholeskyDet(MatrixView<T, true> l) {
+    double det = 1;
+    for (size_t k = 0; k < l.RowNum(); k++) {
+        det *= l[k][k];
+    }
+    return det * det;
+}
+
+template <typename T>
+Matrix<T> CholeskyInverse(MatrixView<T, true> l) {
+    Matrix<T> inv = Matrix<T>::Identity(l.ColNum(), l.RowNum());
+    CholeskySolve(l, MatrixView<T, false>{inv});
+    return inv;
+}
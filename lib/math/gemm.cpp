@@ -0,0 +1,253 @@
+#include "math/gemm.hpp"
+
+#include "job_system.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// register of the micro kernel, same compile time choice as the SMatrix
+// specializations; the fallback is one element wide
+template <typename T>
+struct SimdOps {
+    using Reg = T;
+    static constexpr size_t Lanes = 1;
+    static Reg Zero() { return 0; }
+    static Reg Load(const T* p) { return *p; }
+    static void Store(T* p, Reg r) { *p = r; }
+    static Reg Broadcast(T value) { return value; }
+    static Reg Add(Reg a, Reg b) { return a + b; }
+    static Reg MulAdd(Reg acc, Reg a, Reg b) { return acc + a * b; }
+};
+
+#if defined(SMATRIX_AVX)
+template <>
+struct SimdOps<float> {
+    using Reg = __m256;
+    static constexpr size_t Lanes = 8;
+    static Reg Zero() { return _mm256_setzero_ps(); }
+    static Reg Load(const float* p) { return _mm256_loadu_ps(p); }
+    static void Store(float* p, Reg r) { _mm256_storeu_ps(p, r); }
+    static Reg Broadcast(float value) { return _mm256_set1_ps(value); }
+    static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+    static Reg MulAdd(Reg acc, Reg a, Reg b) {
+        return _mm256_add_ps(acc, _mm256_mul_ps(a, b));
+    }
+};
+
+template <>
+struct SimdOps<double> {
+    using Reg = __m256d;
+    static constexpr size_t Lanes = 4;
+    static Reg Zero() { return _mm256_setzero_pd(); }
+    static Reg Load(const double* p) { return _mm256_loadu_pd(p); }
+    static void Store(double* p, Reg r) { _mm256_storeu_pd(p, r); }
+    static Reg Broadcast(double value) { return _mm256_set1_pd(value); }
+    static Reg Add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+    static Reg MulAdd(Reg acc, Reg a, Reg b) {
+        return _mm256_add_pd(acc, _mm256_mul_pd(a, b));
+    }
+};
+#elif defined(SMATRIX_SSE)
+template <>
+struct SimdOps<float> {
+    using Reg = __m128;
+    static constexpr size_t Lanes = 4;
+    static Reg Zero() { return _mm_setzero_ps(); }
+    static Reg Load(const float* p) { return _mm_loadu_ps(p); }
+    static void Store(float* p, Reg r) { _mm_storeu_ps(p, r); }
+    static Reg Broadcast(float value) { return _mm_set1_ps(value); }
+    static Reg Add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+    static Reg MulAdd(Reg acc, Reg a, Reg b) {
+        return _mm_add_ps(acc, _mm_mul_ps(a, b));
+    }
+};
+
+template <>
+struct SimdOps<double> {
+    using Reg = __m128d;
+    static constexpr size_t Lanes = 2;
+    static Reg Zero() { return _mm_setzero_pd(); }
+    static Reg Load(const double* p) { return _mm_loadu_pd(p); }
+    static void Store(double* p, Reg r) { _mm_storeu_pd(p, r); }
+    static Reg Broadcast(double value) { return _mm_set1_pd(value); }
+    static Reg Add(Reg a, Reg b) { return _mm_add_pd(a, b); }
+    static Reg MulAdd(Reg acc, Reg a, Reg b) {
+        return _mm_add_pd(acc, _mm_mul_pd(a, b));
+    }
+};
+#endif
+
+// register tile of c is MR x NR, two registers of rows by NR columns so the
+// accumulators stay in registers; the block sizes keep a packed panel of b
+// in L1 and a block of a in L2
+template <typename T>
+struct GemmBlocking {
+    static constexpr size_t MR = 2 * SimdOps<T>::Lanes;
+    static constexpr size_t NR = 4;
+    static constexpr size_t MC = 128;
+    static constexpr size_t KC = 256;
+    static constexpr size_t NC = 256;
+};
+
+// rows [row, row + m) of columns [col, col + k) into panels of MR rows,
+// each panel stores MR values per column, short panels are zero padded
+template <typename T>
+void packA(MatrixView<T, true> a, size_t row, size_t m, size_t col,
+           size_t k, T* out) {
+    constexpr size_t MR = GemmBlocking<T>::MR;
+    for (size_t i = 0; i < m; i += MR) {
+        size_t rows = std::min(MR, m - i);
+        for (size_t p = 0; p < k; p++) {
+            const T* src = a[col + p].Ptr() + row + i;
+            size_t r = 0;
+            for (; r < rows; r++) {
+                out[r] = src[r];
+            }
+            for (; r < MR; r++) {
+                out[r] = 0;
+            }
+            out += MR;
+        }
+    }
+}
+
+// rows [row, row + k) of columns [col, col + n) into panels of NR columns,
+// each panel stores NR values per row
+template <typename T>
+void packB(MatrixView<T, true> b, size_t row, size_t k, size_t col,
+           size_t n, T* out) {
+    constexpr size_t NR = GemmBlocking<T>::NR;
+    for (size_t j = 0; j < n; j += NR) {
+        size_t cols = std::min(NR, n - j);
+        const T* src[NR];
+        for (size_t c = 0; c < NR; c++) {
+            src[c] = b[col + j + std::min(c, cols - 1)].Ptr() + row;
+        }
+        for (size_t p = 0; p < k; p++) {
+            for (size_t c = 0; c < NR; c++) {
+                out[c] = c < cols ? src[c][p] : 0;
+            }
+            out += NR;
+        }
+    }
+}
+
+// c[m x n] += panel a * panel b
+template <typename T>
+void microKernel(size_t k, const T* a, const T* b, T* c, size_t ldc,
+                 size_t m, size_t n) {
+    using Ops = SimdOps<T>;
+    using Reg = typename Ops::Reg;
+    constexpr size_t L = Ops::Lanes;
+    constexpr size_t MR = GemmBlocking<T>::MR;
+    constexpr size_t NR = GemmBlocking<T>::NR;
+    Reg acc[NR][2];
+    for (size_t j = 0; j < NR; j++) {
+        acc[j][0] = Ops::Zero();
+        acc[j][1] = Ops::Zero();
+    }
+    for (size_t p = 0; p < k; p++) {
+        Reg a0 = Ops::Load(a);
+        Reg a1 = Ops::Load(a + L);
+        for (size_t j = 0; j < NR; j++) {
+            Reg bj = Ops::Broadcast(b[j]);
+            acc[j][0] = Ops::MulAdd(acc[j][0], a0, bj);
+            acc[j][1] = Ops::MulAdd(acc[j][1], a1, bj);
+        }
+        a += MR;
+        b += NR;
+    }
+
+    if (m == MR && n == NR) {
+        for (size_t j = 0; j < NR; j++) {
+            T* col = c + j * ldc;
+            Ops::Store(col, Ops::Add(acc[j][0], Ops::Load(col)));
+            Ops::Store(col + L, Ops::Add(acc[j][1], Ops::Load(col + L)));
+        }
+        return;
+    }
+    T tile[NR][MR];
+    for (size_t j = 0; j < NR; j++) {
+        Ops::Store(tile[j], acc[j][0]);
+        Ops::Store(tile[j] + L, acc[j][1]);
+    }
+    for (size_t j = 0; j < n; j++) {
+        T* col = c + j * ldc;
+        for (size_t i = 0; i < m; i++) {
+            col[i] += tile[j][i];
+        }
+    }
+}
+
+template <typename T>
+void gemmTile(MatrixView<T, true> a, MatrixView<T, true> b,
+              MatrixView<T, false> c, size_t row, size_t m, size_t col,
+              size_t n, std::vector<T>& packedA, std::vector<T>& packedB) {
+    using Blocking = GemmBlocking<T>;
+    constexpr size_t MR = Blocking::MR;
+    constexpr size_t NR = Blocking::NR;
+    size_t depth = a.ColNum();
+
+    for (size_t j = 0; j < n; j++) {
+        std::fill_n(c[col + j].Ptr() + row, m, T{});
+    }
+
+    size_t ldc = c.ColStride();
+    for (size_t p = 0; p < depth; p += Blocking::KC) {
+        size_t k = std::min(Blocking::KC, depth - p);
+        packA(a, row, m, p, k, packedA.data());
+        packB(b, p, k, col, n, packedB.data());
+        for (size_t j = 0; j < n; j += NR) {
+            for (size_t i = 0; i < m; i += MR) {
+                microKernel(k, packedA.data() + i * k, packedB.data() + j * k,
+                            c[col + j].Ptr() + row + i, ldc,
+                            std::min(MR, m - i), std::min(NR, n - j));
+            }
+        }
+    }
+}
+
+}  // namespace
+
+template <typename T>
+void Gemm(MatrixView<T, true> a, MatrixView<T, true> b, MatrixView<T, false> c,
+          JobSystem* jobSystem) {
+    using Blocking = GemmBlocking<T>;
+    assert(a.ColNum() == b.RowNum());
+    assert(c.RowNum() == a.RowNum() && c.ColNum() == b.ColNum());
+    size_t rows = c.RowNum();
+    size_t cols = c.ColNum();
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+
+    size_t rowTiles = (rows + Blocking::MC - 1) / Blocking::MC;
+    size_t colTiles = (cols + Blocking::NC - 1) / Blocking::NC;
+    // panels are padded to whole register tiles
+    size_t depth = std::min(Blocking::KC, a.ColNum());
+    size_t packedASize = (std::min(Blocking::MC, rows) + Blocking::MR) * depth;
+    size_t packedBSize = (std::min(Blocking::NC, cols) + Blocking::NR) * depth;
+    auto tiles = [&](uint32_t begin, uint32_t end, uint32_t) {
+        std::vector<T> packedA(packedASize);
+        std::vector<T> packedB(packedBSize);
+        for (uint32_t t = begin; t < end; t++) {
+            size_t row = (t % rowTiles) * Blocking::MC;
+            size_t col = (t / rowTiles) * Blocking::NC;
+            gemmTile(a, b, c, row, std::min(Blocking::MC, rows - row), col,
+                     std::min(Blocking::NC, cols - col), packedA, packedB);
+        }
+    };
+
+    uint32_t tileCount = static_cast<uint32_t>(rowTiles * colTiles);
+    if (jobSystem) {
+        jobSystem->ParallelFor(tileCount, 1, tiles);
+    } else {
+        tiles(0, tileCount, 0);
+    }
+}
+
+template void Gemm<float>(MatrixView<float, true>, MatrixView<float, true>,
+                          MatrixView<float, false>, JobSystem*);
+template void Gemm<double>(MatrixView<double, true>, MatrixView<double, true>,
+                           MatrixView<double, false>, JobSystem*);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "math/view.hpp"
+
+class JobSystem;
+
+/**
+ * @brief c = a * b by a cache blocked kernel: blocks of a and b are packed
+ * into contiguous panels and a register tile of c is accumulated from them
+ * @param jobSystem  when given, tiles of c are split across its threads,
+ * each tile is summed by one thread in a fixed order so the result doesn't
+ * depend on the thread count. Must not be called from inside a job
+ * @note only float and double, c must not alias a or b
+ */
+template <typename T>
+void Gemm(MatrixView<T, true> a, MatrixView<T, true> b, MatrixView<T, false> c,
+          JobSystem* jobSystem = nullptr);
+
+extern template void Gemm<float>(MatrixView<float, true>,
+                                 MatrixView<float, true>,
+                                 MatrixView<float, false>, JobSystem*);
+extern template void Gemm<double>(MatrixView<double, true>,
+                                  MatrixView<double, true>,
+                                  MatrixView<double, false>, JobSystem*);
@@ -5,6 +5,7 @@
 #include "math/units.hpp"
 #include "math/algorithm.hpp"
 #include "math/quaternion.hpp"
+#include "math/sparse.hpp"
 
 using MathElemType = float;
 using DMat = Matrix<MathElemType>;
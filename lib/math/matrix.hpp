@@ -1,9 +1,20 @@
 #pragma once
+#include "math/arena.hpp"
 #include <cassert>
 #include <cstring>
 #include <type_traits>
 #include <utility>
 
+/**
+ * @brief lazy element-wise expression, see math/expression.hpp
+ */
+template <typename E>
+concept ElementWiseExpr = requires(const E& e, size_t i) {
+    e.Elem(i, i);
+    e.ColNum();
+    e.RowNum();
+};
+
 template <typename T, bool IsConst = true>
 class Column {
 public:
@@ -29,6 +40,9 @@ public:
         return datas_[idx];
     }
 
+    // elements are contiguous, for loops that skip the bounds checks
+    auto Ptr() const noexcept { return datas_; }
+
 private:
     std::conditional_t<IsConst, const ElemType*, ElemType*> datas_{};
     size_t len_{};
@@ -86,24 +100,33 @@ public:
         return m;
     }
 
-    Matrix(size_t col, size_t row): row_{row}, col_{col} {
-        auto elemCount = ElemCount();
-        if (elemCount <= SMOElemCount) {
-            memset(data_.smo, ElemType{}, sizeof(data_.smo));
-        } else {
-            data_.elems = new ElemType[elemCount];
-            memset(data_.elems, ElemType{}, sizeof(ElemType) * elemCount);
-        }
+    /**
+     * @brief storage above SMOElemCount comes from MatrixArena::Current() if
+     * set, as for expression results
+     * @note such a matrix, and any it is moved into, must not be used after
+     * the arena's next Reset. Copies always use the global allocator, copy
+     * a result that has to outlive the arena scope
+     */
+    Matrix(size_t col, size_t row)
+        : Matrix(col, row, MatrixArena::Current()) {}
+
+    /**
+     * @param arena  nullptr for the global allocator, otherwise the matrix
+     * must not be used after the arena's next Reset
+     */
+    Matrix(size_t col, size_t row, MatrixArena* arena)
+        : row_{row}, col_{col} {
+        allocate(arena);
+        memset(Ptr(), ElemType{}, sizeof(ElemType) * ElemCount());
     }
 
+    // every element is written by the expression, so no zeroing first
+    template <ElementWiseExpr E>
+    Matrix(const E& e) : Matrix(e, MatrixArena::Current()) {}
+
     Matrix(const Matrix& o) : row_{o.row_}, col_{o.col_} {
-        auto elemCount = ElemCount();
-        if (elemCount <= SMOElemCount) {
-            memcpy(data_.smo, o.data_.smo, sizeof(ElemType) * elemCount);
-        } else {
-            data_.elems = new ElemType[elemCount];
-            memcpy(data_.elems, o.data_.elems, sizeof(ElemType) * elemCount);
-        }
+        allocate(nullptr);
+        memcpy(Ptr(), o.Ptr(), sizeof(ElemType) * ElemCount());
     }
 
     Matrix(Matrix&& o) : Matrix() { swap(o, *this); }
@@ -117,12 +140,25 @@ public:
         swap(o, *this);
         return *this;
     }
+
+    // reuses the storage when the size matches, otherwise reallocates from
+    // where the storage came from so a matrix never moves into an arena
+    template <ElementWiseExpr E>
+    Matrix& operator=(const E& e) {
+        if (e.ColNum() != col_ || e.RowNum() != row_) {
+            Matrix m{e, arena_};
+            swap(m, *this);
+        } else {
+            evaluate(e);
+        }
+        return *this;
+    }
     
     template <typename... Ts>
     requires((std::convertible_to<Ts, ElemType> && ...) && sizeof...(Ts) >= 1)
     void SetValuesFromRow(Ts... elems) {
         ElemType datas[] = {static_cast<ElemType>(elems)...};
-        for (int i = 0; i < std::min(sizeof...(elems), ElemCount()); i++) {
+        for (size_t i = 0; i < std::min(sizeof...(elems), ElemCount()); i++) {
             size_t row = i / col_;
             size_t col = i % col_;
             (*this)[col][row] = datas[i];
@@ -142,13 +178,13 @@ public:
         auto minLen = std::min(row_, col_);
         constexpr size_t elemCount = sizeof...(elems);
         if constexpr (elemCount == 0) {
-            for (int i = 0; i < minLen; i++) {
+            for (size_t i = 0; i < minLen; i++) {
                 (*this)[i][i] = elem;
             }
         } else {
             ElemType datas[] = {static_cast<ElemType>(elem),
                                 static_cast<ElemType>(elems)...};
-            for (int i = 0; i < std::min(minLen, elemCount); i++) {
+            for (size_t i = 0; i < std::min(minLen, elemCount + 1); i++) {
                 (*this)[i][i] = datas[i];
             }
         }
@@ -173,9 +209,9 @@ public:
             return false;
         }
 
-        for (int r = 0; r < row_; r++) {
-            for (int c = 0; c < col_; c++) {
-                if (operator[](c)[r] != operator[](c)[r]) {
+        for (size_t r = 0; r < row_; r++) {
+            for (size_t c = 0; c < col_; c++) {
+                if (operator[](c)[r] != o[c][r]) {
                     return false;
                 }
             }
@@ -199,7 +235,7 @@ public:
     auto RowNum() const noexcept { return row_; }
 
     ~Matrix() {
-        if (ElemCount() > SMOElemCount) {
+        if (ElemCount() > SMOElemCount && !arena_) {
             delete[] data_.elems;
         }
     }
@@ -212,13 +248,41 @@ private:
 
     size_t row_;
     size_t col_;
+    MatrixArena* arena_ = nullptr;  // owns data_.elems when set
     
-    Matrix() : row_{0}, col_{0}, data_{0} {}
+    Matrix() : data_{0}, row_{0}, col_{0} {}
+
+    template <ElementWiseExpr E>
+    Matrix(const E& e, MatrixArena* arena)
+        : row_{e.RowNum()}, col_{e.ColNum()} {
+        allocate(arena);
+        evaluate(e);
+    }
+
+    void allocate(MatrixArena* arena) {
+        if (ElemCount() <= SMOElemCount) {
+            return;
+        }
+        arena_ = arena;
+        data_.elems = arena ? arena->Allocate<ElemType>(ElemCount())
+                            : new ElemType[ElemCount()];
+    }
+
+    template <typename E>
+    void evaluate(const E& e) {
+        ElemType* datas = Ptr();
+        for (size_t c = 0; c < col_; c++) {
+            for (size_t r = 0; r < row_; r++) {
+                datas[c * row_ + r] = e.Elem(c, r);
+            }
+        }
+    }
 
     friend void swap(Matrix& m1, Matrix& m2) noexcept {
         using std::swap;
         swap(m1.col_, m2.col_);
         swap(m1.row_, m2.row_);
         swap(m1.data_, m2.data_);
+        swap(m1.arena_, m2.arena_);
     }
 };
\ No newline at end of file
@@ -188,7 +188,7 @@ public:
 template <typename T, size_t Len>
 auto operator+(const SVector<T, Len>& v1, const SVector<T, Len>& v2) noexcept {
     SVector<T, Len> v;
-    for (int i = 0; i < Len; i++) {
+    for (size_t i = 0; i < Len; i++) {
         v[i] = v1[i] + v2[i];
     }
     return v;
@@ -197,7 +197,7 @@ auto operator+(const SVector<T, Len>& v1, const SVector<T, Len>& v2) noexcept {
 template <typename T, size_t Len>
 auto operator-(const SVector<T, Len>& v1, const SVector<T, Len>& v2) noexcept {
     SVector<T, Len> v;
-    for (int i = 0; i < Len; i++) {
+    for (size_t i = 0; i < Len; i++) {
         v[i] = v1[i] - v2[i];
     }
     return v;
@@ -206,7 +206,7 @@ auto operator-(const SVector<T, Len>& v1, const SVector<T, Len>& v2) noexcept {
 template <typename T, size_t Len>
 auto operator*(const SVector<T, Len>& v1, const SVector<T, Len>& v2) noexcept {
     SVector<T, Len> v;
-    for (int i = 0; i < Len; i++) {
+    for (size_t i = 0; i < Len; i++) {
         v[i] = v1[i] * v2[i];
     }
     return v;
@@ -215,7 +215,7 @@ auto operator*(const SVector<T, Len>& v1, const SVector<T, Len>& v2) noexcept {
 template <typename T, typename U, size_t Len>
 auto operator*(const SVector<T, Len>& v1, U value) noexcept {
     SVector<T, Len> v;
-    for (int i = 0; i < Len; i++) {
+    for (size_t i = 0; i < Len; i++) {
         v[i] = v1[i] * value;
     }
     return v;
@@ -229,7 +229,7 @@ auto operator*(U value, const SVector<T, Len>& v) noexcept {
 template <typename T, size_t Len>
 auto operator/(const SVector<T, Len>& v1, const SVector<T, Len>& v2) noexcept {
     SVector<T, Len> v;
-    for (int i = 0; i < Len; i++) {
+    for (size_t i = 0; i < Len; i++) {
         v[i] = v1[i] / v2[i];
     }
     return v;
@@ -238,7 +238,7 @@ auto operator/(const SVector<T, Len>& v1, const SVector<T, Len>& v2) noexcept {
 template <typename T, typename U, size_t Len>
 auto operator/(const SVector<T, Len>& v1, U value) noexcept {
     SVector<T, Len> v;
-    for (int i = 0; i < Len; i++) {
+    for (size_t i = 0; i < Len; i++) {
         v[i] = v1[i] / value;
     }
     return v;
@@ -247,7 +247,7 @@ auto operator/(const SVector<T, Len>& v1, U value) noexcept {
 template <typename T, size_t Len>
 std::ostream& operator<<(std::ostream& o, const SVector<T, Len>& view) {
     o << "[" << std::endl;
-    for (int i = 0; i < Len; i++) {
+    for (size_t i = 0; i < Len; i++) {
         o << view[i] << std::endl;
     }
     o << "]";
@@ -309,7 +309,7 @@ public:
     requires((std::convertible_to<Ts, ElemType> && ...) && sizeof...(Ts) >= 1)
     void SetValuesFromRow(Ts... elems) {
         ElemType datas[] = {static_cast<ElemType>(elems)...};
-        for (int i = 0; i < std::min(sizeof...(elems), ElemCount()); i++) {
+        for (size_t i = 0; i < std::min(sizeof...(elems), ElemCount()); i++) {
             size_t row = i / Col;
             size_t col = i % Col;
             operator[](col)[row] = datas[i];
@@ -329,13 +329,13 @@ public:
         auto minLen = std::min(Col, Row);
         constexpr size_t elemCount = sizeof...(elems);
         if constexpr (elemCount == 0) {
-            for (int i = 0; i < minLen; i++) {
+            for (size_t i = 0; i < minLen; i++) {
                 (*this)[i][i] = elem;
             }
         } else {
             ElemType datas[] = {static_cast<ElemType>(elem),
                                 static_cast<ElemType>(elems)...};
-            for (int i = 0; i < std::min(minLen, elemCount); i++) {
+            for (size_t i = 0; i < std::min(minLen, elemCount + 1); i++) {
                 (*this)[i][i] = datas[i];
             }
         }
@@ -352,9 +352,9 @@ public:
     auto& operator[](size_t i) noexcept { return data_[i]; }
 
     bool operator==(const SMatrix& o) const noexcept {
-        for (int r = 0; r < Row; r++) {
-            for (int c = 0; c < Col; c++) {
-                if ((*this)[c][r] != (*this)[c][r]) {
+        for (size_t r = 0; r < Row; r++) {
+            for (size_t c = 0; c < Col; c++) {
+                if ((*this)[c][r] != o[c][r]) {
                     return false;
                 }
             }
@@ -384,8 +384,8 @@ template <typename T, size_t Col, size_t Row>
 SMatrix<T, Col, Row> operator+(const SMatrix<T, Col, Row>& m1,
                                const SMatrix<T, Col, Row>& m2) {
     SMatrix<T, Col, Row> m;
-    for (int c = 0; c < Col; c++) {
-        for (int r = 0; r < Row; r++) {
+    for (size_t c = 0; c < Col; c++) {
+        for (size_t r = 0; r < Row; r++) {
             m[c][r] = m1[c][r] + m2[c][r];
         }
     }
@@ -396,8 +396,8 @@ template <typename T, size_t Col, size_t Row>
 SMatrix<T, Col, Row> operator-(const SMatrix<T, Col, Row>& m1,
                                const SMatrix<T, Col, Row>& m2) {
     SMatrix<T, Col, Row> m;
-    for (int c = 0; c < Col; c++) {
-        for (int r = 0; r < Row; r++) {
+    for (size_t c = 0; c < Col; c++) {
+        for (size_t r = 0; r < Row; r++) {
             m[c][r] = m1[c][r] - m2[c][r];
         }
     }
@@ -407,8 +407,8 @@ SMatrix<T, Col, Row> operator-(const SMatrix<T, Col, Row>& m1,
 template <typename T, typename U, size_t Col, size_t Row>
 SMatrix<T, Col, Row> operator*(const SMatrix<T, Col, Row>& m1, U value) {
     SMatrix<T, Col, Row> m;
-    for (int c = 0; c < Col; c++) {
-        for (int r = 0; r < Row; r++) {
+    for (size_t c = 0; c < Col; c++) {
+        for (size_t r = 0; r < Row; r++) {
             m[c][r] = m1[c][r] * value;
         }
     }
@@ -423,8 +423,8 @@ SMatrix<T, Col, Row> operator*(U value, const SMatrix<T, Col, Row>& m1) {
 template <typename T, typename U, size_t Col, size_t Row>
 SMatrix<T, Col, Row> operator/(const SMatrix<T, Col, Row>& m1, U value) {
     SMatrix<T, Col, Row> m;
-    for (int c = 0; c < Col; c++) {
-        for (int r = 0; r < Row; r++) {
+    for (size_t c = 0; c < Col; c++) {
+        for (size_t r = 0; r < Row; r++) {
             m[c][r] = m1[c][r] / value;
         }
     }
@@ -436,10 +436,10 @@ SMatrix<T, Col, Row> operator*(const SMatrix<T, Len, Row>& m1,
                                const SMatrix<T, Col, Len>& m2) {
     SMatrix<T, Col, Row> mat;
 
-    for (int m = 0; m < Row; m++) {
-        for (int r = 0; r < Col; r++) {
+    for (size_t m = 0; m < Row; m++) {
+        for (size_t r = 0; r < Col; r++) {
             double sum = 0;
-            for (int n = 0; n < Len; n++) {
+            for (size_t n = 0; n < Len; n++) {
                 sum += m1[n][m] * m2[r][n];
             }
             mat[r][m] = sum;
@@ -452,8 +452,8 @@ template <typename T, size_t Col, size_t Row>
 SMatrix<T, Col, Row> MulEach(const SMatrix<T, Col, Row>& m1,
                              const SMatrix<T, Col, Row>& m2) {
     SMatrix<T, Col, Row> m;
-    for (int c = 0; c < Col; c++) {
-        for (int r = 0; r < Row; r++) {
+    for (size_t c = 0; c < Col; c++) {
+        for (size_t r = 0; r < Row; r++) {
             m[c][r] = m1[c][r] * m2[c][r];
         }
     }
@@ -464,8 +464,8 @@ template <typename T, size_t Col, size_t Row>
 SMatrix<T, Col, Row> DivEach(const SMatrix<T, Col, Row>& m1,
                              const SMatrix<T, Col, Row>& m2) {
     SMatrix<T, Col, Row> m;
-    for (int c = 0; c < Col; c++) {
-        for (int r = 0; r < Row; r++) {
+    for (size_t c = 0; c < Col; c++) {
+        for (size_t r = 0; r < Row; r++) {
             m[c][r] = m1[c][r] / m2[c][r];
         }
     }
@@ -477,12 +477,128 @@ SVector<T, Row> operator*(const SMatrix<T, Col, Row>& m,
                                const SVector<T, Col>& v) {
     SVector<T, Row> result;
 
-    for (int r = 0; r < Row; r++) {
+    for (size_t r = 0; r < Row; r++) {
         result[r] = 0;
-        for (int c = 0; c < Col; c++) {
+        for (size_t c = 0; c < Col; c++) {
             result[r] += m[c][r] * v[c];
         }
     }
 
     return result;
-}
\ No newline at end of file
+}
+
+// SIMD specializations, picked at compile time. SVector<float, 4> and a
+// column of SMatrix<float, 4, 4> are four packed floats, so they load as one
+// register; without SSE the generic templates above are used
+
+#if defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SMATRIX_SSE
+#include <xmmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define SMATRIX_AVX
+#include <immintrin.h>
+#endif
+
+#ifdef SMATRIX_SSE
+
+inline __m128 LoadVec4(const float* p) noexcept { return _mm_loadu_ps(p); }
+
+inline SVector<float, 4> StoreVec4(__m128 x) noexcept {
+    SVector<float, 4> v;
+    _mm_storeu_ps(v.Ptr(), x);
+    return v;
+}
+
+inline SVector<float, 4> operator+(const SVector<float, 4>& v1,
+                                   const SVector<float, 4>& v2) noexcept {
+    return StoreVec4(_mm_add_ps(LoadVec4(v1.Ptr()), LoadVec4(v2.Ptr())));
+}
+
+inline SVector<float, 4> operator-(const SVector<float, 4>& v1,
+                                   const SVector<float, 4>& v2) noexcept {
+    return StoreVec4(_mm_sub_ps(LoadVec4(v1.Ptr()), LoadVec4(v2.Ptr())));
+}
+
+inline SVector<float, 4> operator*(const SVector<float, 4>& v1,
+                                   const SVector<float, 4>& v2) noexcept {
+    return StoreVec4(_mm_mul_ps(LoadVec4(v1.Ptr()), LoadVec4(v2.Ptr())));
+}
+
+inline SVector<float, 4> operator/(const SVector<float, 4>& v1,
+                                   const SVector<float, 4>& v2) noexcept {
+    return StoreVec4(_mm_div_ps(LoadVec4(v1.Ptr()), LoadVec4(v2.Ptr())));
+}
+
+inline SVector<float, 4> operator*(const SVector<float, 4>& v,
+                                   float value) noexcept {
+    return StoreVec4(_mm_mul_ps(LoadVec4(v.Ptr()), _mm_set1_ps(value)));
+}
+
+inline SVector<float, 4> operator*(float value,
+                                   const SVector<float, 4>& v) noexcept {
+    return v * value;
+}
+
+inline SVector<float, 4> operator/(const SVector<float, 4>& v,
+                                   float value) noexcept {
+    return StoreVec4(_mm_div_ps(LoadVec4(v.Ptr()), _mm_set1_ps(value)));
+}
+
+// sum of the columns of m weighted by the lanes of v
+inline __m128 MulColumns4(const float* m, __m128 v) noexcept {
+    __m128 r = _mm_mul_ps(LoadVec4(m),
+                          _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+    r = _mm_add_ps(r, _mm_mul_ps(LoadVec4(m + 4),
+                          _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+    r = _mm_add_ps(r, _mm_mul_ps(LoadVec4(m + 8),
+                          _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+    r = _mm_add_ps(r, _mm_mul_ps(LoadVec4(m + 12),
+                          _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+    return r;
+}
+
+inline SVector<float, 4> operator*(const SMatrix<float, 4, 4>& m,
+                                   const SVector<float, 4>& v) noexcept {
+    return StoreVec4(MulColumns4(m.Ptr(), LoadVec4(v.Ptr())));
+}
+
+/**
+ * @brief sums in float, unlike the generic product which sums in double, so
+ * results can differ in the last bit
+ */
+inline SMatrix<float, 4, 4> operator*(const SMatrix<float, 4, 4>& m1,
+                                      const SMatrix<float, 4, 4>& m2) noexcept {
+    SMatrix<float, 4, 4> mat;
+    const float* a = m1.Ptr();
+    const float* b = m2.Ptr();
+    float* out = mat.Ptr();
+#ifdef SMATRIX_AVX
+    // two result columns per register, each 128 bit half sees all of m1
+    __m256 cols[4];
+    for (size_t c = 0; c < 4; c++) {
+        __m128 col = LoadVec4(a + c * 4);
+        cols[c] = _mm256_insertf128_ps(_mm256_castps128_ps256(col), col, 1);
+    }
+    for (size_t c = 0; c < 4; c += 2) {
+        __m256 v = _mm256_loadu_ps(b + c * 4);
+        __m256 r = _mm256_mul_ps(cols[0], _mm256_shuffle_ps(v, v, 0x00));
+        r = _mm256_add_ps(
+            r, _mm256_mul_ps(cols[1], _mm256_shuffle_ps(v, v, 0x55)));
+        r = _mm256_add_ps(
+            r, _mm256_mul_ps(cols[2], _mm256_shuffle_ps(v, v, 0xaa)));
+        r = _mm256_add_ps(
+            r, _mm256_mul_ps(cols[3], _mm256_shuffle_ps(v, v, 0xff)));
+        _mm256_storeu_ps(out + c * 4, r);
+    }
+#else
+    for (size_t c = 0; c < 4; c++) {
+        _mm_storeu_ps(out + c * 4, MulColumns4(a, LoadVec4(b + c * 4)));
+    }
+#endif
+    return mat;
+}
+
+#endif
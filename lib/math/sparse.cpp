@@ -0,0 +1,196 @@
+#include "math/sparse.hpp"
+
+#include "job_system.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr uint32_t SparseRowGrainSize = 256;
+
+template <typename T>
+double Dot(const std::vector<T>& a, const std::vector<T>& b) {
+    double sum = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+}  // namespace
+
+template <typename T>
+SparseMatrix<T> SparseMatrix<T>::FromEntries(
+    size_t col, size_t row, std::vector<SparseEntry<T>> entries) {
+    std::sort(entries.begin(), entries.end(),
+              [](const SparseEntry<T>& a, const SparseEntry<T>& b) {
+                  return a.row != b.row ? a.row < b.row : a.col < b.col;
+              });
+
+    SparseMatrix m{col, row};
+    m.cols_.reserve(entries.size());
+    m.values_.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        const SparseEntry<T>& entry = entries[i];
+        assert(entry.col < col && entry.row < row);
+        if (i > 0 && entry.row == entries[i - 1].row &&
+            entry.col == entries[i - 1].col) {
+            m.values_.back() += entry.value;
+            continue;
+        }
+        m.cols_.push_back(static_cast<uint32_t>(entry.col));
+        m.values_.push_back(entry.value);
+        m.rowStarts_[entry.row + 1]++;
+    }
+    for (size_t r = 0; r < row; r++) {
+        m.rowStarts_[r + 1] += m.rowStarts_[r];
+    }
+    return m;
+}
+
+template <typename T>
+T SparseMatrix<T>::Diagonal(size_t row) const noexcept {
+    const uint32_t* begin = cols_.data() + rowStarts_[row];
+    const uint32_t* end = cols_.data() + rowStarts_[row + 1];
+    const uint32_t* it = std::lower_bound(begin, end, row);
+    return it != end && *it == row ? values_[it - cols_.data()] : T{};
+}
+
+template <typename T>
+void Mul(const SparseMatrix<T>& m, const std::vector<T>& x, std::vector<T>& y,
+         JobSystem* jobSystem) {
+    assert(x.size() == m.ColNum());
+    y.resize(m.RowNum());
+    const uint32_t* starts = m.RowStarts();
+    const uint32_t* cols = m.ColIndices();
+    const T* values = m.Values();
+    auto rows = [&](uint32_t begin, uint32_t end, uint32_t) {
+        for (uint32_t r = begin; r < end; r++) {
+            T sum = 0;
+            for (uint32_t k = starts[r]; k < starts[r + 1]; k++) {
+                sum += values[k] * x[cols[k]];
+            }
+            y[r] = sum;
+        }
+    };
+
+    uint32_t count = static_cast<uint32_t>(m.RowNum());
+    if (jobSystem) {
+        jobSystem->ParallelFor(count, SparseRowGrainSize, rows);
+    } else {
+        rows(0, count, 0);
+    }
+}
+
+template <typename T>
+IterativeSolveResult ProjectedGaussSeidel(const SparseMatrix<T>& a,
+                                          const std::vector<T>& b,
+                                          const std::vector<T>& lo,
+                                          const std::vector<T>& hi,
+                                          std::vector<T>& x,
+                                          uint32_t maxIterations,
+                                          double tolerance) {
+    assert(a.ColNum() == a.RowNum() && b.size() == a.RowNum());
+    size_t n = a.RowNum();
+    x.resize(n);
+    const uint32_t* starts = a.RowStarts();
+    const uint32_t* cols = a.ColIndices();
+    const T* values = a.Values();
+
+    std::vector<T> invDiagonals(n);
+    for (size_t r = 0; r < n; r++) {
+        T diagonal = a.Diagonal(r);
+        assert(diagonal > 0);
+        invDiagonals[r] = T(1) / diagonal;
+    }
+
+    IterativeSolveResult result;
+    while (result.iterations < maxIterations) {
+        result.iterations++;
+        double maxDelta = 0;
+        for (size_t r = 0; r < n; r++) {
+            T residual = b[r];
+            for (uint32_t k = starts[r]; k < starts[r + 1]; k++) {
+                residual -= values[k] * x[cols[k]];
+            }
+            T value = std::clamp(x[r] + residual * invDiagonals[r], lo[r],
+                                 hi[r]);
+            maxDelta = std::max(maxDelta, double(std::abs(value - x[r])));
+            x[r] = value;
+        }
+        result.residual = maxDelta;
+        if (maxDelta <= tolerance) {
+            break;
+        }
+    }
+    return result;
+}
+
+template <typename T>
+IterativeSolveResult ConjugateGradient(const SparseMatrix<T>& a,
+                                       const std::vector<T>& b,
+                                       std::vector<T>& x,
+                                       uint32_t maxIterations,
+                                       double tolerance,
+                                       JobSystem* jobSystem) {
+    assert(a.ColNum() == a.RowNum() && b.size() == a.RowNum());
+    size_t n = a.RowNum();
+    x.resize(n);
+
+    std::vector<T> r(n), p(n), ap(n);
+    Mul(a, x, ap, jobSystem);
+    for (size_t i = 0; i < n; i++) {
+        r[i] = b[i] - ap[i];
+    }
+    p = r;
+    double rr = Dot(r, r);
+
+    IterativeSolveResult result;
+    result.residual = std::sqrt(rr);
+    while (result.iterations < maxIterations && result.residual > tolerance) {
+        result.iterations++;
+        Mul(a, p, ap, jobSystem);
+        double pap = Dot(p, ap);
+        if (pap <= 0) {
+            break;  // a isn't positive definite along p
+        }
+        T alpha = static_cast<T>(rr / pap);
+        for (size_t i = 0; i < n; i++) {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * ap[i];
+        }
+        double rrNext = Dot(r, r);
+        T beta = static_cast<T>(rrNext / rr);
+        for (size_t i = 0; i < n; i++) {
+            p[i] = r[i] + beta * p[i];
+        }
+        rr = rrNext;
+        result.residual = std::sqrt(rr);
+    }
+    return result;
+}
+
+template class SparseMatrix<float>;
+template class SparseMatrix<double>;
+
+template void Mul<float>(const SparseMatrix<float>&, const std::vector<float>&,
+                         std::vector<float>&, JobSystem*);
+template void Mul<double>(const SparseMatrix<double>&,
+                          const std::vector<double>&, std::vector<double>&,
+                          JobSystem*);
+
+template IterativeSolveResult ProjectedGaussSeidel<float>(
+    const SparseMatrix<float>&, const std::vector<float>&,
+    const std::vector<float>&, const std::vector<float>&, std::vector<float>&,
+    uint32_t, double);
+template IterativeSolveResult ProjectedGaussSeidel<double>(
+    const SparseMatrix<double>&, const std::vector<double>&,
+    const std::vector<double>&, const std::vector<double>&,
+    std::vector<double>&, uint32_t, double);
+
+template IterativeSolveResult ConjugateGradient<float>(
+    const SparseMatrix<float>&, const std::vector<float>&,
+    std::vector<float>&, uint32_t, double, JobSystem*);
+template IterativeSolveResult ConjugateGradient<double>(
+    const SparseMatrix<double>&, const std::vector<double>&,
+    std::vector<double>&, uint32_t, double, JobSystem*);
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+template <typename T>
+struct SparseEntry {
+    size_t col;
+    size_t row;
+    T value;
+};
+
+/**
+ * @brief compressed sparse rows: the nonzeros of row r are
+ * [RowStarts()[r], RowStarts()[r + 1]) in ColIndices() and Values(), sorted
+ * by column
+ * @note constraint systems have a few nonzeros per row, so memory and a
+ * product are O(nonzeros) instead of O(n^2)
+ */
+template <typename T>
+class SparseMatrix {
+public:
+    using ElemType = T;
+
+    SparseMatrix(size_t col, size_t row)
+        : col_{col}, row_{row}, rowStarts_(row + 1, 0) {}
+
+    /**
+     * @brief entries may come in any order, duplicates are summed
+     */
+    static SparseMatrix FromEntries(size_t col, size_t row,
+                                    std::vector<SparseEntry<T>> entries);
+
+    size_t ColNum() const noexcept { return col_; }
+    size_t RowNum() const noexcept { return row_; }
+    size_t NonZeroCount() const noexcept { return values_.size(); }
+
+    const uint32_t* RowStarts() const noexcept { return rowStarts_.data(); }
+    const uint32_t* ColIndices() const noexcept { return cols_.data(); }
+    const T* Values() const noexcept { return values_.data(); }
+
+    // 0 when the row has no entry on the diagonal
+    T Diagonal(size_t row) const noexcept;
+
+private:
+    size_t col_;
+    size_t row_;
+    std::vector<uint32_t> rowStarts_;
+    std::vector<uint32_t> cols_;
+    std::vector<T> values_;
+};
+
+// the functions here are defined for float and double in sparse.cpp
+extern template class SparseMatrix<float>;
+extern template class SparseMatrix<double>;
+
+/**
+ * @brief y = m * x
+ * @param jobSystem  when given, rows are split across its threads, each row
+ * is summed by one thread so the result doesn't depend on the thread count
+ */
+template <typename T>
+void Mul(const SparseMatrix<T>& m, const std::vector<T>& x, std::vector<T>& y,
+         JobSystem* jobSystem = nullptr);
+
+struct IterativeSolveResult {
+    uint32_t iterations = 0;
+    double residual = 0;  // largest change of x in the last iteration (PGS)
+                          // or 2-norm of b - a * x (CG)
+};
+
+/**
+ * @brief projected Gauss-Seidel on a * x = b with lo <= x <= hi, the box
+ * clamped problem of accumulated contact impulses
+ * @param x  the start, warm started values converge in fewer iterations
+ * @note a needs a positive diagonal, rows are swept in order so it runs on
+ * one thread
+ */
+template <typename T>
+IterativeSolveResult ProjectedGaussSeidel(const SparseMatrix<T>& a,
+                                          const std::vector<T>& b,
+                                          const std::vector<T>& lo,
+                                          const std::vector<T>& hi,
+                                          std::vector<T>& x,
+                                          uint32_t maxIterations,
+                                          double tolerance);
+
+/**
+ * @brief conjugate gradient on a * x = b for a symmetric positive definite a
+ * @param x  the start
+ * @param jobSystem  for the products, the dot products stay on the caller
+ */
+template <typename T>
+IterativeSolveResult ConjugateGradient(const SparseMatrix<T>& a,
+                                       const std::vector<T>& b,
+                                       std::vector<T>& x,
+                                       uint32_t maxIterations,
+                                       double tolerance,
+                                       JobSystem* jobSystem = nullptr);
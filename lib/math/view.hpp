@@ -3,15 +3,16 @@
 #include "math/matrix.hpp"
 #include "math/smatrix.hpp"
 
-template <typename MatrixType, bool IsConst = true>
+template <typename T, bool IsConst = true>
 class MatrixView {
 public:
-    using ElemType = typename MatrixType::T;
+    using ElemType = T;
+    using MatrixType = Matrix<T>;
 
     template <bool OtherIsConst>
-    MatrixView(const MatrixView<MatrixType, OtherIsConst>& o)
+    MatrixView(const MatrixView<T, OtherIsConst>& o)
     requires(IsConst)
-        : matrix_{&o},
+        : matrix_{o.matrix_},
           colBeg_{o.colBeg_},
           colLen_{o.colLen_},
           rowBeg_{o.rowBeg_},
@@ -19,9 +20,9 @@ public:
           col_{o.col_},
           row_{o.row_} {}
 
-    MatrixView(const MatrixView<MatrixType, false>& o)
+    MatrixView(const MatrixView<T, false>& o)
     requires(!IsConst)
-        : matrix_{&o},
+        : matrix_{o.matrix_},
           colBeg_{o.colBeg_},
           colLen_{o.colLen_},
           rowBeg_{o.rowBeg_},
@@ -78,6 +79,23 @@ public:
     MatrixView(const MatrixView&) = default;
     MatrixView(MatrixView&&) = default;
 
+    /**
+     * @brief write a lazy element-wise expression into the viewed part
+     */
+    template <ElementWiseExpr E>
+    MatrixView& operator=(const E& e)
+    requires(!IsConst)
+    {
+        assert(colLen_ == e.ColNum() && rowLen_ == e.RowNum());
+        for (size_t c = 0; c < colLen_; c++) {
+            ElemType* col = colPtr(c);
+            for (size_t r = 0; r < rowLen_; r++) {
+                col[r] = e.Elem(c, r);
+            }
+        }
+        return *this;
+    }
+
     size_t ElemCount() const noexcept { return colLen_ * rowLen_; }
 
     size_t ColBegin() const noexcept { return colBeg_; }
@@ -94,28 +112,44 @@ public:
 
     bool IsSquare() const noexcept { return colLen_ == rowLen_; }
 
+    // elements from one column to the next, a view keeps the matrix layout
+    size_t ColStride() const noexcept { return row_; }
+
     auto operator[](size_t idx) const noexcept
     requires(IsConst)
     {
         assert(idx < colLen_);
-        return Column<ElemType, IsConst>(*(matrix_->Ptr() + row_ * (idx + colBeg_) + rowBeg_),
-                                  rowLen_);
+        return Column<ElemType, IsConst>(*colPtr(idx), rowLen_);
     }
 
     auto operator[](size_t idx) noexcept
     requires(!IsConst)
     {
         assert(idx < colLen_);
-        return Column<ElemType, IsConst>(*(matrix_->Ptr() + row_ * (idx + colBeg_) + rowBeg_),
-                                  rowLen_);
+        return Column<ElemType, IsConst>(*colPtr(idx), rowLen_);
     }
 
+    /**
+     * @brief copy of the viewed part only
+     */
     MatrixType Clone() const {
-        return *matrix_;
+        MatrixType m(colLen_, rowLen_);
+        for (size_t c = 0; c < colLen_; c++) {
+            memcpy(m[c].Ptr(), colPtr(c), sizeof(ElemType) * rowLen_);
+        }
+        return m;
     }
 
 private:
+    template <typename, bool>
+    friend class MatrixView;
+
     std::conditional_t<IsConst, const MatrixType*, MatrixType*> matrix_ = nullptr;
     size_t colBeg_, colLen_, rowBeg_, rowLen_;
     size_t col_, row_;
+
+    // columns are contiguous, rowLen_ elements from here
+    auto colPtr(size_t idx) const noexcept {
+        return matrix_->Ptr() + row_ * (idx + colBeg_) + rowBeg_;
+    }
 };
\ No newline at end of file
@@ -1,35 +1,500 @@
 #include "scene.hpp"
 
-#include "contact.hpp"
 #include "macro.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
 
-BodyPtr PhysicsScene::CreateBody(ShapePtr shape) {
-    auto body = std::make_shared<Body>();
-    body->m_shape = shape;
-    return m_bodies.emplace_back(std::move(body));
+namespace {
+
+// bodies slower than this for TimeToSleep seconds may fall asleep
+constexpr float LinearSleepTolerance = 0.5f;
+constexpr float AngularSleepTolerance = 2.0f / 180.0f * PI;
+constexpr float TimeToSleep = 0.5f;
+
+// a bullet stops sweeping after this many impacts in one step
+constexpr uint32_t MaxBulletSubsteps = 8;
+
+// work items per job when Update runs on several threads
+constexpr uint32_t BodyGrainSize = 1024;
+constexpr uint32_t PairGrainSize = 128;
+constexpr uint32_t IslandGrainSize = 4;
+
+// islands with this many manifolds are solved by all threads together
+constexpr uint32_t LargeIslandSize = 256;
+
+float MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+}  // namespace
+
+PhysicsScene::PhysicsScene()
+    : m_bodies{m_shapes},
+      m_jobSystem{std::make_unique<JobSystem>(1)},
+      m_broadphase{CreateBroadphase(m_broadphaseType)},
+      m_solvers(1) {
+    m_broadphase->SetJobSystem(m_jobSystem.get());
+}
+
+BodyHandle PhysicsScene::CreateBody(ShapeHandle shape) {
+    RETURN_VALUE_IF_FALSE(shape, BodyHandle{});
+    BodyHandle handle = m_bodies.Add(shape);
+    uint32_t index = m_bodies.GetIndex(handle);
+    m_broadphase->Insert(handle.m_index, m_bodies.GetBounds(index));
+    m_createdBodies.push_back(handle);
+    return handle;
+}
+
+bool PhysicsScene::DestroyBody(BodyHandle handle) {
+    RETURN_FALSE_IF_FALSE(m_bodies.Remove(handle));
+    m_broadphase->Remove(handle.m_index);
+    // contacts refer to bodies by index, which Remove may have changed
+    m_touching.clear();
+    return true;
+}
+
+Body PhysicsScene::GetBody(BodyHandle handle) {
+    uint32_t index = m_bodies.GetIndex(handle);
+    RETURN_DEFAULT_IF_FALSE(index != BodyHandle::InvalidIndex);
+    return Body{m_bodies, index};
+}
+
+void PhysicsScene::SetBroadphase(BroadphaseType type) {
+    m_broadphaseType = type;
+    m_broadphase = CreateBroadphase(type);
+    m_broadphase->SetJobSystem(m_jobSystem.get());
+    for (uint32_t i = 0; i < m_bodies.Size(); ++i) {
+        m_broadphase->Insert(m_bodies.GetSlot(i), m_bodies.GetBounds(i));
+    }
+}
+
+void PhysicsScene::SetThreadCount(uint32_t count) {
+    m_broadphase->SetJobSystem(nullptr);
+    m_jobSystem = std::make_unique<JobSystem>(count);
+    m_broadphase->SetJobSystem(m_jobSystem.get());
+    m_solvers.resize(m_jobSystem->GetThreadCount());
+}
+
+uint32_t PhysicsScene::Step(float frameTime) {
+    m_accumulator += std::max(frameTime, 0.0f);
+
+    // new bodies start interpolating from where they were placed, not from
+    // the origin, even if no step runs this frame
+    for (BodyHandle handle : m_createdBodies) {
+        uint32_t index = m_bodies.GetIndex(handle);
+        CONTINUE_IF(index == BodyHandle::InvalidIndex);
+        m_bodies.m_prevPositions[index] = m_bodies.m_positions[index];
+        m_bodies.m_prevRotations[index] = m_bodies.m_rotations[index];
+    }
+    m_createdBodies.clear();
+
+    uint32_t steps = 0;
+    while (m_accumulator >= m_fixedTimeStep && steps < m_maxSubSteps) {
+        m_bodies.m_prevPositions = m_bodies.m_positions;
+        m_bodies.m_prevRotations = m_bodies.m_rotations;
+        Update(m_fixedTimeStep);
+        m_accumulator -= m_fixedTimeStep;
+        steps++;
+    }
+
+    // fell behind, drop the time instead of spiraling
+    if (m_accumulator >= m_fixedTimeStep) {
+        m_accumulator = std::fmod(m_accumulator, m_fixedTimeStep);
+    }
+    return steps;
 }
 
 void PhysicsScene::Update(float delta_time) {
-    for (auto& body : m_bodies) {
-        CONTINUE_IF(body->m_invMass == 0);
-        Vec2 gravityImpulse = m_gravity * 1.0 / body->m_invMass * delta_time;
-        body->ApplyLinearImpulse(gravityImpulse);
-    }
-
-    for (int i = 0; i < m_bodies.size(); ++i) {
-        for (int j = i; j < m_bodies.size(); ++j) {
-            auto& bodyA = m_bodies[i];
-            auto& bodyB = m_bodies[j];
-            CONTINUE_IF(bodyA->m_invMass == 0 && bodyB->m_invMass == 0);
-            
-            Contact contact;
-            if (Intersect(bodyA, bodyB, contact)) {
-                ResolveContact(contact);
+    auto stepStart = std::chrono::steady_clock::now();
+    // without Step nothing is interpolated
+    m_createdBodies.clear();
+    MatrixArenaScope arenaScope{m_matrixArena};
+
+    uint32_t count = static_cast<uint32_t>(m_bodies.Size());
+    Vec2* positions = m_bodies.m_positions.data();
+    Vec2* linearVels = m_bodies.m_linearVels.data();
+    const float* invMasses = m_bodies.m_invMasses.data();
+
+    // gravity impulse is m * g * dt, so it changes velocity by g * dt
+    Vec2 gravityVel = m_gravity * delta_time;
+    m_jobSystem->ParallelFor(
+        count, BodyGrainSize, [&](uint32_t begin, uint32_t end, uint32_t) {
+            for (uint32_t i = begin; i < end; ++i) {
+                CONTINUE_IF(invMasses[i] == 0 || !m_bodies.IsAwake(i));
+                linearVels[i] += gravityVel;
+            }
+        });
+
+    auto phaseStart = std::chrono::steady_clock::now();
+    // broadphase works on slots, which don't move when bodies are destroyed
+    for (uint32_t i = 0; i < count; ++i) {
+        CONTINUE_IF(!m_bodies.IsAwake(i));
+        m_broadphase->Move(m_bodies.GetSlot(i), m_bodies.GetBounds(i));
+    }
+
+    m_pairs.clear();
+    m_broadphase->FindPairs(m_pairs);
+    m_stepStats.m_broadphaseMs = MillisecondsSince(phaseStart);
+
+    phaseStart = std::chrono::steady_clock::now();
+    collide();
+    m_stepStats.m_narrowphaseMs = MillisecondsSince(phaseStart);
+
+    phaseStart = std::chrono::steady_clock::now();
+    // bullets are swept from where they start the step
+    m_bullets.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        CONTINUE_IF(!m_bodies.m_bullets[i] || invMasses[i] == 0 ||
+                    !m_bodies.IsAwake(i));
+        m_bullets.push_back({i, positions[i], 0, 0});
+    }
+
+    m_islands.Build(m_bodies, m_touching);
+    auto& islands = m_islands.GetIslands();
+    m_islandSleepTimes.resize(islands.size());
+    m_islandRotationUpdates.resize(islands.size());
+    for (auto& solver : m_solvers) {
+        solver.SetWarmStarting(m_warmStarting);
+    }
+    m_smallIslands.clear();
+    m_largeIslands.clear();
+    for (uint32_t i = 0; i < islands.size(); ++i) {
+        if (islands[i].m_manifoldCount >= LargeIslandSize) {
+            m_largeIslands.push_back(i);
+        } else {
+            m_smallIslands.push_back(i);
+        }
+    }
+
+    // islands share no dynamic body, so each can be solved on its own
+    m_jobSystem->ParallelFor(
+        static_cast<uint32_t>(m_smallIslands.size()), IslandGrainSize,
+        [&](uint32_t begin, uint32_t end, uint32_t thread) {
+            for (uint32_t i = begin; i < end; ++i) {
+                solveIsland(m_smallIslands[i], m_solvers[thread], nullptr,
+                            delta_time);
+            }
+        });
+
+    // a large island would keep one thread busy, spread its constraints
+    // over all threads instead
+    for (uint32_t i : m_largeIslands) {
+        solveIsland(i, m_solvers[0], m_jobSystem.get(), delta_time);
+    }
+
+    // static bodies are in no island but may have been given a velocity
+    uint32_t rotationUpdates = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        CONTINUE_IF(invMasses[i] != 0);
+        rotationUpdates += m_bodies.Integrate(i, delta_time);
+    }
+    for (uint32_t updates : m_islandRotationUpdates) {
+        rotationUpdates += updates;
+    }
+    m_stepStats.m_rotationUpdates = rotationUpdates;
+
+    if (m_allowSleep) {
+        updateSleep();
+    }
+    m_stepStats.m_solverMs = MillisecondsSince(phaseStart);
+
+    phaseStart = std::chrono::steady_clock::now();
+    solveTimeOfImpact(delta_time);
+    m_stepStats.m_timeOfImpactMs = MillisecondsSince(phaseStart);
+
+    m_stepStats.m_islandCount = static_cast<uint32_t>(islands.size());
+    m_stepStats.m_largeIslandCount =
+        static_cast<uint32_t>(m_largeIslands.size());
+    m_stepStats.m_threadCount = m_jobSystem->GetThreadCount();
+    m_stepStats.m_steals = m_jobSystem->GetStealCount();
+    if (m_matrixArena) {
+        m_matrixArena->Reset();
+    }
+    m_stepStats.m_matrixArenaPeakBytes =
+        m_matrixArena ? m_matrixArena->GetPeakBytes() : 0;
+    m_stepStats.m_totalMs = MillisecondsSince(stepStart);
+}
+
+void PhysicsScene::collide() {
+    const float* invMasses = m_bodies.m_invMasses.data();
+
+    // awake states are only read here, a body woken by a pair below joins
+    // the narrowphase with its other pairs next step
+    uint32_t pairCount = static_cast<uint32_t>(m_pairs.size());
+    m_pairResults.resize(pairCount);
+    m_jobSystem->ParallelFor(
+        pairCount, PairGrainSize, [&](uint32_t begin, uint32_t end, uint32_t) {
+            for (uint32_t i = begin; i < end; ++i) {
+                PairResult& result = m_pairResults[i];
+                uint32_t a = m_bodies.GetIndexOfSlot(m_pairs[i].m_a);
+                uint32_t b = m_bodies.GetIndexOfSlot(m_pairs[i].m_b);
+                bool activeA = invMasses[a] != 0 && m_bodies.IsAwake(a);
+                bool activeB = invMasses[b] != 0 && m_bodies.IsAwake(b);
+                result.m_tested = activeA || activeB;
+                CONTINUE_IF_FALSE(result.m_tested);
+
+                // the cache only reads here, it's written back below
+                BodyHandle handleA = m_bodies.GetHandle(a);
+                const Manifold* m =
+                    m_manifolds.Find(handleA, m_bodies.GetHandle(b));
+                bool warm = m_narrowphaseWarmStart && m &&
+                            m->m_bodyA == handleA;
+                result.m_cache = warm ? m->m_cache : CollideCache{};
+                result.m_cache.m_gjkIterations = 0;
+                result.m_contactCount =
+                    Intersect(m_bodies, a, b, result.m_cache,
+                              result.m_contacts);
             }
+        });
+
+    // cache updates stay serial and in pair order
+    m_manifolds.BeginStep();
+    m_stepStats.m_gjkQueries = 0;
+    m_stepStats.m_gjkIterations = 0;
+    for (uint32_t i = 0; i < pairCount; ++i) {
+        const PairResult& result = m_pairResults[i];
+        CONTINUE_IF_FALSE(result.m_tested);
+        if (result.m_cache.m_gjkIterations > 0) {
+            m_stepStats.m_gjkQueries++;
+            m_stepStats.m_gjkIterations += result.m_cache.m_gjkIterations;
+        }
+        uint32_t a = m_bodies.GetIndexOfSlot(m_pairs[i].m_a);
+        uint32_t b = m_bodies.GetIndexOfSlot(m_pairs[i].m_b);
+
+        // touching a sleeping island wakes all of it
+        if (result.m_contactCount > 0) {
+            m_bodies.WakeUp(a);
+            m_bodies.WakeUp(b);
+        }
+        m_manifolds.Add(m_bodies, a, b, result.m_cache, result.m_contacts,
+                        result.m_contactCount);
+    }
+    // pairs of sleeping bodies were skipped and get evicted here
+    m_manifolds.EndStep();
+
+    // no insertion until next step, pointers into the cache stay valid
+    m_touching.clear();
+    m_manifolds.ForEach([&](Manifold& m) {
+        if (m.m_contactCount > 0) {
+            m_touching.push_back(&m);
         }
+    });
+}
+
+void PhysicsScene::solveIsland(uint32_t index, ContactSolver& solver,
+                               JobSystem* jobSystem, float delta_time) {
+    const Island& island = m_islands.GetIslands()[index];
+    const uint32_t* bodies = m_islands.GetBodies(island);
+    const Vec2* linearVels = m_bodies.m_linearVels.data();
+    const float* angularVels = m_bodies.m_angularVels.data();
+    float* sleepTimes = m_bodies.m_sleepTimes.data();
+
+    solver.Prepare(m_bodies, m_islands.GetManifolds(island),
+                   island.m_manifoldCount);
+    if (jobSystem) {
+        solver.Color(m_bodies.Size());
+    }
+    for (uint32_t i = 0; i < m_solverIterations; ++i) {
+        solver.SolveVelocities(m_bodies, jobSystem);
     }
+    solver.StoreImpulses();
+
+    uint32_t rotationUpdates = 0;
+    for (uint32_t k = 0; k < island.m_bodyCount; ++k) {
+        rotationUpdates += m_bodies.Integrate(bodies[k], delta_time);
+    }
+
+    if (island.m_manifoldCount > 0) {
+        for (uint32_t i = 0; i < m_positionIterations; ++i) {
+            BREAK_IF_FALSE(!solver.SolvePositions(m_bodies, jobSystem));
+        }
+        // the solver only keeps the cached cos/sin close, make them exact
+        for (uint32_t k = 0; k < island.m_bodyCount; ++k) {
+            uint32_t i = bodies[k];
+            m_bodies.SetRotation(i, m_bodies.m_rotations[i]);
+        }
+        rotationUpdates += island.m_bodyCount;
+    }
+    m_islandRotationUpdates[index] = rotationUpdates;
+
+    // an island sleeps only when all of its bodies have been slow long enough
+    float minSleepTime = std::numeric_limits<float>::max();
+    for (uint32_t k = 0; k < island.m_bodyCount; ++k) {
+        uint32_t i = bodies[k];
+        if (LengthSqrd(linearVels[i]) >
+                LinearSleepTolerance * LinearSleepTolerance ||
+            std::abs(angularVels[i]) > AngularSleepTolerance) {
+            sleepTimes[i] = 0;
+        } else {
+            sleepTimes[i] += delta_time;
+        }
+        minSleepTime = std::min(minSleepTime, sleepTimes[i]);
+    }
+    m_islandSleepTimes[index] = minSleepTime;
+}
+
+void PhysicsScene::solveTimeOfImpact(float delta_time) {
+    RETURN_IF_FALSE(!m_bullets.empty());
+    uint32_t count = static_cast<uint32_t>(m_bodies.Size());
+    Vec2* positions = m_bodies.m_positions.data();
+    Vec2* linearVels = m_bodies.m_linearVels.data();
+    const float* invMasses = m_bodies.m_invMasses.data();
+    const float* elasticities = m_bodies.m_elasticities.data();
+
+    // sweeps are tested against where the other bodies ended the step
+    for (uint32_t i = 0; i < count; ++i) {
+        CONTINUE_IF(!m_bodies.IsAwake(i));
+        m_broadphase->Move(m_bodies.GetSlot(i), m_bodies.GetBounds(i));
+    }
+
+    auto later = [](const TimeOfImpactEvent& e1, const TimeOfImpactEvent& e2) {
+        return e1.m_time > e2.m_time ||
+               (e1.m_time == e2.m_time && e1.m_bullet > e2.m_bullet);
+    };
 
-    for (auto& body : m_bodies) {
-        body->m_position += body->m_linearVel * delta_time;
+    m_timeOfImpactEvents.clear();
+    for (uint32_t k = 0; k < m_bullets.size(); ++k) {
+        TimeOfImpactEvent event;
+        CONTINUE_IF_FALSE(m_bodies.IsAwake(m_bullets[k].m_index) &&
+                          findTimeOfImpact(k, delta_time, event));
+        m_timeOfImpactEvents.push_back(event);
+        std::push_heap(m_timeOfImpactEvents.begin(),
+                       m_timeOfImpactEvents.end(), later);
     }
-}
\ No newline at end of file
+
+    // earliest impact first, a bullet continues with the rest of its step
+    // and may hit again
+    uint32_t substeps = 0;
+    while (!m_timeOfImpactEvents.empty()) {
+        std::pop_heap(m_timeOfImpactEvents.begin(),
+                      m_timeOfImpactEvents.end(), later);
+        TimeOfImpactEvent event = m_timeOfImpactEvents.back();
+        m_timeOfImpactEvents.pop_back();
+        substeps++;
+
+        Bullet& bullet = m_bullets[event.m_bullet];
+        const Contact& contact = event.m_contact;
+        uint32_t a = contact.m_bodyA;
+        uint32_t b = contact.m_bodyB;
+        bullet.m_start = event.m_position;
+        bullet.m_time = event.m_time;
+        bullet.m_substeps++;
+        positions[a] = bullet.m_start;
+
+        // same response as the contact solver, bounce only if fast enough
+        float vn = Dot(linearVels[b] - linearVels[a], contact.m_normal);
+        if (vn < 0) {
+            float elasticity = vn < -ContactSolver::RestitutionThreshold
+                                   ? elasticities[a] * elasticities[b]
+                                   : 0;
+            float impulse =
+                -(1.0f + elasticity) * vn / (invMasses[a] + invMasses[b]);
+            linearVels[a] -= contact.m_normal * (impulse * invMasses[a]);
+            linearVels[b] += contact.m_normal * (impulse * invMasses[b]);
+        }
+        m_bodies.WakeUp(b);
+
+        if (bullet.m_substeps < MaxBulletSubsteps &&
+            findTimeOfImpact(event.m_bullet, delta_time, event)) {
+            m_timeOfImpactEvents.push_back(event);
+            std::push_heap(m_timeOfImpactEvents.begin(),
+                           m_timeOfImpactEvents.end(), later);
+        } else {
+            positions[a] +=
+                linearVels[a] * ((1.0f - bullet.m_time) * delta_time);
+        }
+    }
+    m_stepStats.m_timeOfImpactSubsteps = substeps;
+}
+
+bool PhysicsScene::findTimeOfImpact(uint32_t bullet, float delta_time,
+                                    TimeOfImpactEvent& event) {
+    const Bullet& b = m_bullets[bullet];
+    uint32_t a = b.m_index;
+    Vec2 translation =
+        m_bodies.m_linearVels[a] * ((1.0f - b.m_time) * delta_time);
+    ShapeHandle shape = m_bodies.m_shapes[a];
+    const Rotation2D& rotation = m_bodies.m_cosSins[a];
+    AABB swept = AABB::Merge(
+        m_bodies.GetShapes().GetBounds(shape, {b.m_start, rotation}),
+        m_bodies.GetShapes().GetBounds(shape,
+                                       {b.m_start + translation, rotation}));
+
+    bool found = false;
+    float minToi = 1.0f;
+    m_broadphase->QueryAABB(swept, [&](uint32_t slot) {
+        uint32_t other = m_bodies.GetIndexOfSlot(slot);
+        RETURN_TRUE_IF_FALSE(other != a && !m_bodies.m_bullets[other]);
+
+        Contact contact;
+        RETURN_TRUE_IF_FALSE(TimeOfImpact(m_bodies, a, b.m_start, translation,
+                                          other, contact));
+        // ties go to the lower index so the query order doesn't matter
+        RETURN_TRUE_IF_FALSE(
+            !found || contact.m_toi < minToi ||
+            (contact.m_toi == minToi && other < event.m_contact.m_bodyB));
+        found = true;
+        minToi = contact.m_toi;
+        event.m_contact = contact;
+        return true;
+    });
+    RETURN_FALSE_IF_FALSE(found);
+
+    event.m_bullet = bullet;
+    event.m_time = b.m_time + minToi * (1.0f - b.m_time);
+    event.m_position = b.m_start + translation * minToi;
+    return true;
+}
+
+void PhysicsScene::updateSleep() {
+    auto& islands = m_islands.GetIslands();
+    for (size_t i = 0; i < islands.size(); ++i) {
+        CONTINUE_IF(m_islandSleepTimes[i] < TimeToSleep);
+        m_bodies.PutToSleep(m_islands.GetBodies(islands[i]),
+                            islands[i].m_bodyCount);
+    }
+}
+
+void PhysicsScene::SetAllowSleep(bool allow) {
+    m_allowSleep = allow;
+    RETURN_IF_FALSE(!allow);
+    for (uint32_t i = 0; i < m_bodies.Size(); ++i) {
+        m_bodies.WakeUp(i);
+    }
+}
+
+void PhysicsScene::QueryAABB(const AABB& bounds,
+                             std::vector<BodyHandle>& bodies) {
+    m_broadphase->QueryAABB(bounds, [&](uint32_t slot) {
+        // the broadphase may store enlarged bounds, recheck the exact ones
+        uint32_t index = m_bodies.GetIndexOfSlot(slot);
+        if (m_bodies.GetBounds(index).IsIntersect(bounds)) {
+            bodies.push_back(m_bodies.GetHandle(index));
+        }
+        return true;
+    });
+}
+
+std::optional<RayCastResult> PhysicsScene::RayCast(const Vec2& from,
+                                                   const Vec2& to) {
+    std::optional<RayCastResult> result;
+    m_broadphase->RayCast(from, to, [&](uint32_t slot, float maxFraction) {
+        uint32_t index = m_bodies.GetIndexOfSlot(slot);
+        float fraction = maxFraction;
+        Vec2 normal;
+        if (!m_shapes.RayCast(m_bodies.m_shapes[index],
+                              m_bodies.GetTransform(index), from, to,
+                              fraction, normal)) {
+            return maxFraction;
+        }
+
+        result = RayCastResult{m_bodies.GetHandle(index),
+                               from + (to - from) * fraction, normal, fraction};
+        return fraction;
+    });
+    return result;
+}
@@ -1,15 +1,268 @@
 #pragma once
 
 #include "body.hpp"
+#include "broadphase.hpp"
+#include "contact.hpp"
+#include "island.hpp"
+#include "job_system.hpp"
+#include "manifold.hpp"
+#include "math/arena.hpp"
+#include "solver.hpp"
+#include <memory>
+#include <optional>
 #include <vector>
 
+struct RayCastResult {
+    BodyHandle m_body;
+    Vec2 m_point;
+    Vec2 m_normal;
+    float m_fraction;
+};
+
+/**
+ * @brief wall time of the phases of the last Update, compare runs with
+ * different thread counts to see the speedup
+ */
+struct StepStats {
+    float m_broadphaseMs = 0;
+    float m_narrowphaseMs = 0;
+    float m_solverMs = 0;
+    float m_totalMs = 0;
+    uint32_t m_islandCount = 0;
+    uint32_t m_largeIslandCount = 0;  // solved with graph coloring
+    uint32_t m_threadCount = 1;
+    uint64_t m_steals = 0;  // jobs stolen by idle threads since creation
+    float m_timeOfImpactMs = 0;
+    uint32_t m_timeOfImpactSubsteps = 0;  // bullet impacts handled
+    uint32_t m_gjkQueries = 0;
+    uint32_t m_gjkIterations = 0;  // summed over the queries
+    // cos/sin pairs computed for body rotations, the only ones in a step
+    uint32_t m_rotationUpdates = 0;
+    // most the arena set with SetMatrixArena held since its last reset
+    size_t m_matrixArenaPeakBytes = 0;
+};
+
 class PhysicsScene {
 public:
     Vec2 m_gravity;
-    
-    BodyPtr CreateBody(ShapePtr shape);
+
+    PhysicsScene();
+
+    // bodies and compound shapes point into m_shapes, a copy or a moved to
+    // scene would still read the shapes of the old one
+    PhysicsScene(const PhysicsScene&) = delete;
+    PhysicsScene(PhysicsScene&&) = delete;
+    PhysicsScene& operator=(const PhysicsScene&) = delete;
+    PhysicsScene& operator=(PhysicsScene&&) = delete;
+
+    /**
+     * @brief shapes are stored by value and can be shared between bodies
+     */
+    template <typename T>
+    ShapeHandle CreateShape(const T& shape) {
+        return m_shapes.Add(shape);
+    }
+
+    // children of a ShapeCompound refer to shapes stored here
+    const ShapeStorage& GetShapes() const { return m_shapes; }
+
+    BodyHandle CreateBody(ShapeHandle shape);
+
+    template <typename T>
+    BodyHandle CreateBody(const T& shape) {
+        return CreateBody(CreateShape(shape));
+    }
+
+    // return false if the handle is stale
+    bool DestroyBody(BodyHandle handle);
+
+    bool IsValid(BodyHandle handle) const { return m_bodies.IsValid(handle); }
+
+    /**
+     * @brief get a temporary view of the body, it is null if the handle is
+     * stale and invalidated by the next CreateBody/DestroyBody
+     */
+    Body GetBody(BodyHandle handle);
+
+    /**
+     * @brief advance one step of delta_time, prefer Step for frame driven
+     * simulation
+     */
     void Update(float delta_time);
-    
+
+    /**
+     * @brief advance by a frame's time in fixed steps, the remainder is
+     * carried over to the next frame
+     * @note at most max sub steps are run, time beyond that is dropped so a
+     * slow frame can't make the next one slower
+     * @return count of fixed steps run
+     */
+    uint32_t Step(float frameTime);
+
+    void SetFixedTimeStep(float timeStep) { m_fixedTimeStep = timeStep; }
+
+    float GetFixedTimeStep() const { return m_fixedTimeStep; }
+
+    void SetMaxSubSteps(uint32_t count) { m_maxSubSteps = count; }
+
+    uint32_t GetMaxSubSteps() const { return m_maxSubSteps; }
+
+    /**
+     * @brief how far the carried over time is into the next fixed step, in
+     * [0, 1), see Body::GetInterpolatedPosition
+     */
+    float GetInterpolationAlpha() const {
+        return m_accumulator / m_fixedTimeStep;
+    }
+
+    /**
+     * @brief switch broadphase algorithm, all bodies are moved to the new one
+     */
+    void SetBroadphase(BroadphaseType type);
+
+    BroadphaseType GetBroadphaseType() const { return m_broadphaseType; }
+
+    const BroadphaseStats& GetBroadphaseStats() const {
+        return m_broadphase->GetStats();
+    }
+
+    /**
+     * @brief velocity iterations of the contact solver per step, more
+     * iterations give stiffer stacks
+     */
+    void SetSolverIterations(uint32_t iterations) {
+        m_solverIterations = iterations;
+    }
+
+    uint32_t GetSolverIterations() const { return m_solverIterations; }
+
+    /**
+     * @brief max iterations of penetration correction per step, stops early
+     * once contacts are resolved
+     */
+    void SetPositionIterations(uint32_t iterations) {
+        m_positionIterations = iterations;
+    }
+
+    uint32_t GetPositionIterations() const { return m_positionIterations; }
+
+    void SetWarmStarting(bool enable) { m_warmStarting = enable; }
+
+    /**
+     * @brief start each pair's narrowphase from what it found last step, the
+     * SAT axis or the GJK simplex
+     */
+    void SetNarrowphaseWarmStart(bool enable) {
+        m_narrowphaseWarmStart = enable;
+    }
+
+    /**
+     * @brief run broadphase cells, narrowphase pairs and islands on count
+     * threads including the caller, 0 means one per hardware thread
+     * @note results are bit identical for every thread count
+     */
+    void SetThreadCount(uint32_t count);
+
+    uint32_t GetThreadCount() const { return m_jobSystem->GetThreadCount(); }
+
+    const StepStats& GetStepStats() const { return m_stepStats; }
+
+    /**
+     * @brief matrices built on the calling thread during Update come from
+     * arena, which Update resets before it returns so StepStats can report
+     * its peak, nullptr for the global allocator
+     * @note the arena isn't owned, temporaries the caller builds in it
+     * between steps count towards the next step and are gone after it
+     */
+    void SetMatrixArena(MatrixArena* arena) { m_matrixArena = arena; }
+
+    MatrixArena* GetMatrixArena() const { return m_matrixArena; }
+
+    /**
+     * @brief islands of bodies at rest fall asleep and cost nothing until
+     * touched, disallowing sleep wakes all bodies
+     */
+    void SetAllowSleep(bool allow);
+
+    bool IsSleepAllowed() const { return m_allowSleep; }
+
+    /**
+     * @brief manifolds of the body pairs touching in the last step
+     */
+    const std::vector<Manifold*>& GetManifolds() const { return m_touching; }
+
+    void QueryAABB(const AABB& bounds, std::vector<BodyHandle>& bodies);
+    std::optional<RayCastResult> RayCast(const Vec2& from, const Vec2& to);
+
 private:
-    std::vector<BodyPtr> m_bodies;
+    // narrowphase output of one broadphase pair
+    struct PairResult {
+        Contact m_contacts[MaxManifoldContacts];
+        uint32_t m_contactCount;
+        CollideCache m_cache;
+        bool m_tested;  // false if both bodies are asleep or static
+    };
+
+    ShapeStorage m_shapes;  // must outlive m_bodies
+    BodyStorage m_bodies;
+    BroadphaseType m_broadphaseType = BroadphaseType::AABBTree;
+    std::unique_ptr<JobSystem> m_jobSystem;  // must outlive m_broadphase
+    BroadphasePtr m_broadphase;
+    std::vector<BroadphasePair> m_pairs;
+    ManifoldCache m_manifolds;
+    std::vector<Manifold*> m_touching;
+    std::vector<PairResult> m_pairResults;
+    std::vector<ContactSolver> m_solvers;  // one per thread
+    uint32_t m_solverIterations = 8;
+    uint32_t m_positionIterations = 3;
+    bool m_warmStarting = true;
+    bool m_narrowphaseWarmStart = true;
+    IslandBuilder m_islands;
+    std::vector<float> m_islandSleepTimes;
+    std::vector<uint32_t> m_islandRotationUpdates;
+    std::vector<uint32_t> m_smallIslands;
+    std::vector<uint32_t> m_largeIslands;
+    bool m_allowSleep = true;
+    StepStats m_stepStats;
+    MatrixArena* m_matrixArena = nullptr;
+    // bodies created since the last step, they have no previous state to
+    // interpolate from until Step gives them their current one
+    std::vector<BodyHandle> m_createdBodies;
+    float m_fixedTimeStep = 1.0f / 60.0f;
+    uint32_t m_maxSubSteps = 4;
+    float m_accumulator = 0;
+
+    struct Bullet {
+        uint32_t m_index;
+        Vec2 m_start;         // where the rest of the sweep starts
+        float m_time;         // fraction of the step already swept
+        uint32_t m_substeps;
+    };
+
+    struct TimeOfImpactEvent {
+        float m_time;  // fraction of the step
+        uint32_t m_bullet;
+        Vec2 m_position;
+        Contact m_contact;
+    };
+
+    std::vector<Bullet> m_bullets;
+    std::vector<TimeOfImpactEvent> m_timeOfImpactEvents;  // min heap
+
+    void collide();
+    /**
+     * @param jobSystem  non null solves the island with colored constraints
+     * spread over threads
+     */
+    void solveIsland(uint32_t index, ContactSolver& solver,
+                     JobSystem* jobSystem, float delta_time);
+    void updateSleep();
+
+    /**
+     * @brief sweep bullets through the step and handle their impacts in
+     * time order
+     */
+    void solveTimeOfImpact(float delta_time);
+    bool findTimeOfImpact(uint32_t bullet, float delta_time,
+                          TimeOfImpactEvent& event);
 };
@@ -0,0 +1,463 @@
+#include "shape.hpp"
+#include "gjk.hpp"
+#include "macro.hpp"
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+AABB PointBounds(const Vec2* points, uint32_t count) {
+    AABB bounds = AABB::Empty();
+    for (uint32_t i = 0; i < count; ++i) {
+        bounds = AABB::Merge(bounds, AABB{points[i], points[i]});
+    }
+    return bounds;
+}
+
+// bounds of local bounds placed at a transform
+AABB TransformBounds(const AABB& local, const Transform2D& transform) {
+    Vec2 corners[] = {
+        local.m_min,
+        Vec2{local.m_max.x, local.m_min.y},
+        local.m_max,
+        Vec2{local.m_min.x, local.m_max.y},
+    };
+    TransformPoints(transform, corners, 4, corners);
+    return PointBounds(corners, 4);
+}
+
+// a chain blob is this header, the vertices, then the BVH nodes
+struct ChainBlobHeader {
+    static constexpr uint32_t Magic = 0x4E494843;  // "CHIN"
+    static constexpr uint32_t Version = 1;
+
+    enum Flags : uint32_t {
+        Loop = 1 << 0,
+        OneSided = 1 << 1,
+    };
+
+    uint32_t m_magic;
+    uint32_t m_version;
+    uint32_t m_vertexCount;
+    uint32_t m_nodeCount;
+    uint32_t m_flags;
+};
+
+static_assert(std::is_trivially_copyable_v<Vec2> && sizeof(Vec2) == 8);
+static_assert(std::is_trivially_copyable_v<BVHNode>);
+
+// vertices and nodes of a chain built in memory
+struct ChainData {
+    std::vector<Vec2> m_vertices;
+    std::vector<BVHNode> m_nodes;
+};
+
+}  // namespace
+
+Vec2 Shape::GetCenterOfMass() const {
+    return m_centerOfMass;
+}
+
+ShapeSphere::ShapeSphere(float radius) : Shape{Type}, m_radius{radius} {}
+
+AABB ShapeSphere::GetBounds(const Transform2D& transform) const {
+    const Vec2& position = transform.m_position;
+    return {position - Vec2{m_radius}, position + Vec2{m_radius}};
+}
+
+bool ShapeSphere::RayCast(const Transform2D& transform, const Vec2& from,
+                          const Vec2& to, float& fraction,
+                          Vec2& normal) const {
+    Vec2 dir = to - from;
+    Vec2 offset = from - transform.m_position;
+    float a = LengthSqrd(dir);
+    float b = Dot(offset, dir);
+    float c = LengthSqrd(offset) - m_radius * m_radius;
+    float discriminant = b * b - a * c;
+    RETURN_FALSE_IF_FALSE(a > 0 && discriminant >= 0);
+
+    float t = (-b - std::sqrt(discriminant)) / a;
+    RETURN_FALSE_IF_FALSE(t >= 0 && t <= fraction);
+
+    fraction = t;
+    normal = Normalize(offset + dir * t);
+    return true;
+}
+
+ShapePolygon::ShapePolygon(const Vec2* points, uint32_t count)
+    : Shape{Type}, m_count{std::min(count, MaxVertices)} {
+    assert(count >= 3 && count <= MaxVertices);
+
+    // area weighted centroid and polar moment of the triangle fan around
+    // the origin
+    float area = 0;
+    Vec2 center{0, 0};
+    float inertia = 0;
+    for (uint32_t i = 0; i < m_count; ++i) {
+        m_vertices[i] = points[i];
+        const Vec2& v1 = points[i];
+        const Vec2& v2 = points[(i + 1) % m_count];
+        m_normals[i] = Normalize(Vec2{v2.y - v1.y, v1.x - v2.x});
+
+        float triangleArea = 0.5f * Cross(v1, v2);
+        area += triangleArea;
+        center += (v1 + v2) * (triangleArea / 3.0f);
+        inertia += triangleArea / 6.0f *
+                   (Dot(v1, v1) + Dot(v1, v2) + Dot(v2, v2));
+    }
+    m_area = area;
+    m_centerOfMass = area > 0 ? center / area : Vec2{0, 0};
+    // parallel axis theorem moves it to the center of mass
+    m_inertia = inertia - area * LengthSqrd(m_centerOfMass);
+}
+
+ShapePolygon ShapePolygon::Box(float halfWidth, float halfHeight) {
+    Vec2 points[] = {
+        Vec2{-halfWidth, -halfHeight},
+        Vec2{halfWidth, -halfHeight},
+        Vec2{halfWidth, halfHeight},
+        Vec2{-halfWidth, halfHeight},
+    };
+    return ShapePolygon{points, 4};
+}
+
+AABB ShapePolygon::GetBounds(const Transform2D& transform) const {
+    Vec2 vertices[MaxVertices];
+    TransformPoints(transform, m_vertices, m_count, vertices);
+    return PointBounds(vertices, m_count);
+}
+
+bool ShapePolygon::RayCast(const Transform2D& transform, const Vec2& from,
+                           const Vec2& to, float& fraction,
+                           Vec2& normal) const {
+    // clip the segment by every edge's half plane in local space
+    Vec2 p1 = transform.ApplyInverse(from);
+    Vec2 dir = transform.m_rotation.ApplyInverse(to - from);
+
+    float lower = 0;
+    float upper = fraction;
+    int32_t hitEdge = -1;
+    for (uint32_t i = 0; i < m_count; ++i) {
+        float numerator = Dot(m_normals[i], m_vertices[i] - p1);
+        float denominator = Dot(m_normals[i], dir);
+        if (denominator == 0) {
+            RETURN_FALSE_IF_FALSE(numerator >= 0);
+            continue;
+        }
+        float t = numerator / denominator;
+        if (denominator < 0 && t > lower) {
+            lower = t;
+            hitEdge = static_cast<int32_t>(i);
+        } else if (denominator > 0 && t < upper) {
+            upper = t;
+        }
+        RETURN_FALSE_IF_FALSE(lower <= upper);
+    }
+    // a ray starting inside doesn't hit
+    RETURN_FALSE_IF_FALSE(hitEdge >= 0);
+
+    fraction = lower;
+    normal = transform.m_rotation.Apply(m_normals[hitEdge]);
+    return true;
+}
+
+Vec2 ShapePolygon::Support(const Vec2& direction) const {
+    uint32_t best = 0;
+    float bestDot = Dot(direction, m_vertices[0]);
+    for (uint32_t i = 1; i < m_count; ++i) {
+        float d = Dot(direction, m_vertices[i]);
+        if (d > bestDot) {
+            bestDot = d;
+            best = i;
+        }
+    }
+    return m_vertices[best];
+}
+
+ShapeCapsule::ShapeCapsule(const Vec2& center1, const Vec2& center2,
+                           float radius)
+    : Shape{Type}, m_center1{center1}, m_center2{center2}, m_radius{radius} {
+    m_centerOfMass = (center1 + center2) * 0.5f;
+}
+
+float ShapeCapsule::GetInertia() const {
+    // a box between the centers and a disk split onto its ends
+    float length = Length(m_center2 - m_center1);
+    float rr = m_radius * m_radius;
+    float boxArea = 2 * m_radius * length;
+    float boxInertia = boxArea * (length * length + 4 * rr) / 12;
+
+    // each half disk's centroid lies this far out from its center
+    float offset = 4 * m_radius / (3 * PI);
+    float h = 0.5f * length;
+    float diskInertia = PI * rr * (0.5f * rr + h * h + 2 * h * offset);
+    return boxInertia + diskInertia;
+}
+
+AABB ShapeCapsule::GetBounds(const Transform2D& transform) const {
+    Vec2 p1 = transform.Apply(m_center1);
+    Vec2 p2 = transform.Apply(m_center2);
+    AABB bounds = AABB::Merge(AABB{p1, p1}, AABB{p2, p2});
+    return {bounds.m_min - Vec2{m_radius}, bounds.m_max + Vec2{m_radius}};
+}
+
+bool ShapeCapsule::RayCast(const Transform2D& transform, const Vec2& from,
+                           const Vec2& to, float& fraction,
+                           Vec2& normal) const {
+    return ConvexRayCast(ConvexProxy{*this, transform}, from, to, fraction,
+                         normal);
+}
+
+ShapeRoundedBox::ShapeRoundedBox(float halfWidth, float halfHeight,
+                                 float radius)
+    : Shape{Type}, m_halfExtent{halfWidth, halfHeight}, m_radius{radius} {}
+
+float ShapeRoundedBox::GetInertia() const {
+    float hx = m_halfExtent.x;
+    float hy = m_halfExtent.y;
+    float r = m_radius;
+    auto box = [](float w, float h, float distSqrd) {
+        return w * h * ((w * w + h * h) / 12 + distSqrd);
+    };
+    float inertia = box(2 * hx, 2 * hy, 0) +
+                    2 * box(2 * hx, r, (hy + 0.5f * r) * (hy + 0.5f * r)) +
+                    2 * box(r, 2 * hy, (hx + 0.5f * r) * (hx + 0.5f * r));
+
+    // the corner quarter disks make one disk, each moved out to its corner
+    float offset = 4 * r / (3 * PI);
+    inertia += PI * r * r *
+               (0.5f * r * r + hx * hx + hy * hy + 2 * offset * (hx + hy));
+    return inertia;
+}
+
+AABB ShapeRoundedBox::GetBounds(const Transform2D& transform) const {
+    // extent of the rotated core box
+    float cos = std::abs(transform.m_rotation.m_cos);
+    float sin = std::abs(transform.m_rotation.m_sin);
+    Vec2 extent{cos * m_halfExtent.x + sin * m_halfExtent.y + m_radius,
+                sin * m_halfExtent.x + cos * m_halfExtent.y + m_radius};
+    return {transform.m_position - extent, transform.m_position + extent};
+}
+
+bool ShapeRoundedBox::RayCast(const Transform2D& transform, const Vec2& from,
+                              const Vec2& to, float& fraction,
+                              Vec2& normal) const {
+    return ConvexRayCast(ConvexProxy{*this, transform}, from, to, fraction,
+                         normal);
+}
+
+ShapeCompound::ShapeCompound(const ShapeStorage& shapes,
+                             const Child* children, uint32_t count)
+    : Shape{Type}, m_shapes{&shapes}, m_children{children, children + count} {
+    assert(count > 0);
+
+    std::vector<AABB> bounds;
+    std::vector<Vec2> centers;
+    Vec2 center{0, 0};
+    for (uint32_t i = 0; i < count; ++i) {
+        const Child& child = m_children[i];
+        assert(child.m_shape.m_type != Type && "compounds don't nest");
+        m_childTransforms.emplace_back(child.m_position, child.m_rotation);
+        const Transform2D& transform = m_childTransforms.back();
+        bounds.push_back(shapes.GetBounds(child.m_shape, transform));
+
+        float area = shapes.GetArea(child.m_shape);
+        centers.push_back(
+            transform.Apply(shapes.Get(child.m_shape).GetCenterOfMass()));
+        m_area += area;
+        center += centers.back() * area;
+    }
+    m_centerOfMass = m_area > 0 ? center / m_area : Vec2{0, 0};
+
+    // polar moments don't change with rotation, only with the offset
+    for (uint32_t i = 0; i < count; ++i) {
+        ShapeHandle shape = m_children[i].m_shape;
+        m_inertia += shapes.GetInertia(shape) +
+                     shapes.GetArea(shape) *
+                         LengthSqrd(centers[i] - m_centerOfMass);
+    }
+
+    BuildBVH(bounds.data(), count, m_nodes);
+}
+
+AABB ShapeCompound::GetBounds(const Transform2D& transform) const {
+    return TransformBounds(m_nodes[0].m_bounds, transform);
+}
+
+bool ShapeCompound::RayCast(const Transform2D& transform, const Vec2& from,
+                            const Vec2& to, float& fraction,
+                            Vec2& normal) const {
+    Vec2 p1 = transform.ApplyInverse(from);
+    Vec2 p2 = transform.ApplyInverse(to);
+    AABB rayBounds = AABB::Merge(AABB{p1, p1}, AABB{p2, p2});
+
+    // each hit shortens fraction, so later children only report closer hits
+    bool hit = false;
+    Vec2 localNormal;
+    QueryChildren(rayBounds, [&](uint32_t i) {
+        hit |= m_shapes->RayCast(m_children[i].m_shape, m_childTransforms[i],
+                                 p1, p2, fraction, localNormal);
+    });
+    RETURN_FALSE_IF_FALSE(hit);
+    normal = transform.m_rotation.Apply(localNormal);
+    return true;
+}
+
+ShapeChain::ShapeChain(const Vec2* points, uint32_t count, bool loop,
+                       bool oneSided)
+    : Shape{Type}, m_loop{loop}, m_oneSided{oneSided} {
+    assert(count >= 2);
+    auto data = std::make_shared<ChainData>();
+    data->m_vertices.assign(points, points + count);
+    m_vertices = data->m_vertices.data();
+    m_vertexCount = count;
+
+    std::vector<AABB> bounds(GetSegmentCount());
+    for (uint32_t i = 0; i < bounds.size(); ++i) {
+        Vec2 v1, v2;
+        GetSegment(i, v1, v2);
+        bounds[i] = AABB::Merge(AABB{v1, v1}, AABB{v2, v2});
+    }
+    BuildBVH(bounds.data(), static_cast<uint32_t>(bounds.size()),
+             data->m_nodes);
+    m_nodes = data->m_nodes.data();
+    m_nodeCount = static_cast<uint32_t>(data->m_nodes.size());
+    m_owner = std::move(data);
+}
+
+std::optional<ShapeChain> ShapeChain::FromBlob(
+    std::shared_ptr<const void> owner, const void* data, size_t size) {
+    ChainBlobHeader header;
+    RETURN_VALUE_IF_FALSE(size >= sizeof(header), std::nullopt);
+    std::memcpy(&header, data, sizeof(header));
+    RETURN_VALUE_IF_FALSE(header.m_magic == ChainBlobHeader::Magic &&
+                              header.m_version == ChainBlobHeader::Version &&
+                              header.m_vertexCount >= 2,
+                          std::nullopt);
+    size_t verticesSize = size_t{header.m_vertexCount} * sizeof(Vec2);
+    size_t nodesSize = size_t{header.m_nodeCount} * sizeof(BVHNode);
+    RETURN_VALUE_IF_FALSE(size == sizeof(header) + verticesSize + nodesSize,
+                          std::nullopt);
+
+    ShapeChain chain;
+    auto bytes = static_cast<const uint8_t*>(data);
+    chain.m_owner = std::move(owner);
+    chain.m_vertices = reinterpret_cast<const Vec2*>(bytes + sizeof(header));
+    chain.m_vertexCount = header.m_vertexCount;
+    chain.m_nodes = reinterpret_cast<const BVHNode*>(bytes + sizeof(header) +
+                                                     verticesSize);
+    chain.m_nodeCount = header.m_nodeCount;
+    chain.m_loop = header.m_flags & ChainBlobHeader::Loop;
+    chain.m_oneSided = header.m_flags & ChainBlobHeader::OneSided;
+
+    // a corrupt tree would index out of the blob
+    uint32_t segmentCount = chain.GetSegmentCount();
+    RETURN_VALUE_IF_FALSE(chain.m_nodeCount == 2 * segmentCount - 1,
+                          std::nullopt);
+    for (uint32_t i = 0; i < chain.m_nodeCount; ++i) {
+        const BVHNode& node = chain.m_nodes[i];
+        RETURN_VALUE_IF_FALSE(node.m_next > i &&
+                                  node.m_next <= chain.m_nodeCount &&
+                                  (node.m_item == BVHNode::InvalidItem ||
+                                   node.m_item < segmentCount),
+                              std::nullopt);
+    }
+    return chain;
+}
+
+std::optional<ShapeChain> ShapeChain::Load(const char* path) {
+    auto file = MappedFile::Open(path);
+    RETURN_VALUE_IF_FALSE(file, std::nullopt);
+    const void* data = file->GetData();
+    size_t size = file->GetSize();
+    return FromBlob(std::move(file), data, size);
+}
+
+void ShapeChain::WriteBlob(std::vector<uint8_t>& blob) const {
+    ChainBlobHeader header{ChainBlobHeader::Magic, ChainBlobHeader::Version,
+                           m_vertexCount, m_nodeCount, 0};
+    if (m_loop) {
+        header.m_flags |= ChainBlobHeader::Loop;
+    }
+    if (m_oneSided) {
+        header.m_flags |= ChainBlobHeader::OneSided;
+    }
+
+    auto append = [&](const void* data, size_t size) {
+        auto bytes = static_cast<const uint8_t*>(data);
+        blob.insert(blob.end(), bytes, bytes + size);
+    };
+    append(&header, sizeof(header));
+    append(m_vertices, m_vertexCount * sizeof(Vec2));
+    append(m_nodes, m_nodeCount * sizeof(BVHNode));
+}
+
+AABB ShapeChain::GetBounds(const Transform2D& transform) const {
+    return TransformBounds(m_nodes[0].m_bounds, transform);
+}
+
+bool ShapeChain::RayCast(const Transform2D& transform, const Vec2& from,
+                         const Vec2& to, float& fraction,
+                         Vec2& normal) const {
+    Vec2 p1 = transform.ApplyInverse(from);
+    Vec2 dir = transform.m_rotation.ApplyInverse(to - from);
+    Vec2 p2 = p1 + dir;
+
+    bool hit = false;
+    Vec2 localNormal;
+    QuerySegments(AABB::Merge(AABB{p1, p1}, AABB{p2, p2}), [&](uint32_t i) {
+        Vec2 v1, v2;
+        GetSegment(i, v1, v2);
+        Vec2 e = v2 - v1;
+        Vec2 n = Normalize(Vec2{e.y, -e.x});
+
+        float denominator = Dot(n, dir);
+        RETURN_IF_FALSE(denominator != 0);
+        // one-sided segments are only hit from the front
+        RETURN_IF_FALSE(!m_oneSided || denominator < 0);
+        float t = Dot(n, v1 - p1) / denominator;
+        RETURN_IF_FALSE(t >= 0 && t <= fraction);
+        float s = Dot(p1 + dir * t - v1, e) / LengthSqrd(e);
+        RETURN_IF_FALSE(s >= 0 && s <= 1);
+
+        fraction = t;
+        localNormal = denominator < 0 ? n : -n;
+        hit = true;
+    });
+    RETURN_FALSE_IF_FALSE(hit);
+    normal = transform.m_rotation.Apply(localNormal);
+    return true;
+}
+
+const Shape& ShapeStorage::Get(ShapeHandle handle) const {
+    return Visit(handle, [](const auto& shape) -> const Shape& {
+        return shape;
+    });
+}
+
+AABB ShapeStorage::GetBounds(ShapeHandle handle,
+                             const Transform2D& transform) const {
+    return Visit(handle, [&](const auto& shape) {
+        return shape.GetBounds(transform);
+    });
+}
+
+float ShapeStorage::GetArea(ShapeHandle handle) const {
+    return Visit(handle, [](const auto& shape) { return shape.GetArea(); });
+}
+
+float ShapeStorage::GetInertia(ShapeHandle handle) const {
+    return Visit(handle,
+                 [](const auto& shape) { return shape.GetInertia(); });
+}
+
+bool ShapeStorage::RayCast(ShapeHandle handle, const Transform2D& transform,
+                           const Vec2& from, const Vec2& to, float& fraction,
+                           Vec2& normal) const {
+    return Visit(handle, [&](const auto& shape) {
+        return shape.RayCast(transform, from, to, fraction, normal);
+    });
+}
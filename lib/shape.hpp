@@ -0,0 +1,385 @@
+#pragma once
+#include "aabb.hpp"
+#include "bvh.hpp"
+#include "math/math.hpp"
+#include "transform.hpp"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+/**
+ * @note every convex shape also has a support mapping for the generic
+ * narrowphase: Vec2 Support(const Vec2& direction) const gives the point of
+ * its core furthest along direction in local space, float GetRadius() const
+ * how far the core is rounded.
+ * GetInertia() of every shape is the polar moment of its area about the
+ * center of mass, the rotational inertia at density 1
+ */
+class Shape {
+public:
+    enum class ShapeType {
+        Sphere,
+        Polygon,
+        Capsule,
+        RoundedBox,
+        Compound,
+        Chain,
+
+        Count,
+    };
+
+    ShapeType getShapeType() const { return m_type; }
+    Vec2 GetCenterOfMass() const;
+
+protected:
+    explicit Shape(ShapeType type) : m_type{type} {}
+
+    Vec2 m_centerOfMass;
+
+private:
+    ShapeType m_type;
+};
+
+class ShapeSphere : public Shape {
+public:
+    static constexpr ShapeType Type = ShapeType::Sphere;
+
+    ShapeSphere(float radius);
+
+    AABB GetBounds(const Transform2D& transform) const;
+
+    /**
+     * @brief intersect segment from->to with the shape placed in world space
+     * @param fraction  in: max fraction of the segment, out: hit fraction
+     */
+    bool RayCast(const Transform2D& transform, const Vec2& from,
+                 const Vec2& to, float& fraction, Vec2& normal) const;
+
+    float GetArea() const { return PI * m_radius * m_radius; }
+
+    float GetInertia() const {
+        return 0.5f * PI * m_radius * m_radius * m_radius * m_radius;
+    }
+
+    Vec2 Support(const Vec2&) const { return Vec2{0, 0}; }
+    float GetRadius() const { return m_radius; }
+
+    float m_radius;
+};
+
+/**
+ * @brief convex polygon, vertices are in counter clockwise order around the
+ * body origin
+ */
+class ShapePolygon : public Shape {
+public:
+    static constexpr ShapeType Type = ShapeType::Polygon;
+    static constexpr uint32_t MaxVertices = 8;
+
+    /**
+     * @param points  convex and counter clockwise, at most MaxVertices
+     */
+    ShapePolygon(const Vec2* points, uint32_t count);
+
+    static ShapePolygon Box(float halfWidth, float halfHeight);
+
+    AABB GetBounds(const Transform2D& transform) const;
+
+    bool RayCast(const Transform2D& transform, const Vec2& from,
+                 const Vec2& to, float& fraction, Vec2& normal) const;
+
+    float GetArea() const { return m_area; }
+    float GetInertia() const { return m_inertia; }
+
+    Vec2 Support(const Vec2& direction) const;
+    float GetRadius() const { return 0; }
+
+    Vec2 m_vertices[MaxVertices];
+    Vec2 m_normals[MaxVertices];  // normal of edge i -> i + 1
+    uint32_t m_count;
+    float m_area;
+    float m_inertia;
+};
+
+/**
+ * @brief segment center1 -> center2 rounded by radius
+ */
+class ShapeCapsule : public Shape {
+public:
+    static constexpr ShapeType Type = ShapeType::Capsule;
+
+    ShapeCapsule(const Vec2& center1, const Vec2& center2, float radius);
+
+    AABB GetBounds(const Transform2D& transform) const;
+
+    bool RayCast(const Transform2D& transform, const Vec2& from,
+                 const Vec2& to, float& fraction, Vec2& normal) const;
+
+    float GetArea() const {
+        return 2 * m_radius * Length(m_center2 - m_center1) +
+               PI * m_radius * m_radius;
+    }
+
+    float GetInertia() const;
+
+    Vec2 Support(const Vec2& direction) const {
+        return Dot(direction, m_center2 - m_center1) > 0 ? m_center2
+                                                         : m_center1;
+    }
+    float GetRadius() const { return m_radius; }
+
+    Vec2 m_center1;
+    Vec2 m_center2;
+    float m_radius;
+};
+
+/**
+ * @brief box around the body origin with its corners rounded by radius
+ */
+class ShapeRoundedBox : public Shape {
+public:
+    static constexpr ShapeType Type = ShapeType::RoundedBox;
+
+    /**
+     * @param halfWidth, halfHeight  of the core box, the shape is radius
+     * larger on every side
+     */
+    ShapeRoundedBox(float halfWidth, float halfHeight, float radius);
+
+    AABB GetBounds(const Transform2D& transform) const;
+
+    bool RayCast(const Transform2D& transform, const Vec2& from,
+                 const Vec2& to, float& fraction, Vec2& normal) const;
+
+    float GetArea() const {
+        return 4 * m_halfExtent.x * m_halfExtent.y +
+               4 * m_radius * (m_halfExtent.x + m_halfExtent.y) +
+               PI * m_radius * m_radius;
+    }
+
+    float GetInertia() const;
+
+    Vec2 Support(const Vec2& direction) const {
+        return Vec2{direction.x >= 0 ? m_halfExtent.x : -m_halfExtent.x,
+                    direction.y >= 0 ? m_halfExtent.y : -m_halfExtent.y};
+    }
+    float GetRadius() const { return m_radius; }
+
+    Vec2 m_halfExtent;
+    float m_radius;
+};
+
+/**
+ * @brief static chain of segments for level geometry, baked into a BVH once
+ * @note a one-sided segment v1 -> v2 faces (e.y, -e.x) for e = v2 - v1, the
+ * same way as ShapePolygon edges, and bodies behind it pass through. Copies
+ * share the vertices and nodes, which may live in a memory mapped blob
+ */
+class ShapeChain : public Shape {
+public:
+    static constexpr ShapeType Type = ShapeType::Chain;
+
+    /**
+     * @param loop  connect the last point back to the first
+     */
+    ShapeChain(const Vec2* points, uint32_t count, bool loop = false,
+               bool oneSided = true);
+
+    /**
+     * @brief use a blob written by WriteBlob in place
+     * @param owner  keeps data alive as long as a copy of the shape is
+     * @return nullopt if data is not a valid blob
+     */
+    static std::optional<ShapeChain> FromBlob(
+        std::shared_ptr<const void> owner, const void* data, size_t size);
+
+    // memory map a file holding a blob
+    static std::optional<ShapeChain> Load(const char* path);
+
+    // append the vertices and the baked BVH to blob
+    void WriteBlob(std::vector<uint8_t>& blob) const;
+
+    AABB GetBounds(const Transform2D& transform) const;
+
+    bool RayCast(const Transform2D& transform, const Vec2& from,
+                 const Vec2& to, float& fraction, Vec2& normal) const;
+
+    float GetArea() const { return 0; }
+    float GetInertia() const { return 0; }
+
+    uint32_t GetSegmentCount() const {
+        return m_loop ? m_vertexCount : m_vertexCount - 1;
+    }
+
+    void GetSegment(uint32_t i, Vec2& v1, Vec2& v2) const {
+        v1 = m_vertices[i];
+        v2 = m_vertices[i + 1 == m_vertexCount ? 0 : i + 1];
+    }
+
+    bool IsOneSided() const { return m_oneSided; }
+
+    /**
+     * @brief call f with every segment whose bounds overlap bounds in the
+     * chain's local space
+     */
+    template <typename F>
+    void QuerySegments(const AABB& bounds, F&& f) const {
+        QueryBVH(m_nodes, m_nodeCount, bounds, f);
+    }
+
+private:
+    ShapeChain() : Shape{Type} {}
+
+    std::shared_ptr<const void> m_owner;
+    const Vec2* m_vertices = nullptr;
+    uint32_t m_vertexCount = 0;
+    const BVHNode* m_nodes = nullptr;
+    uint32_t m_nodeCount = 0;
+    bool m_loop = false;
+    bool m_oneSided = true;
+};
+
+/**
+ * @brief refer to a shape in a ShapeStorage pool
+ */
+struct ShapeHandle {
+    Shape::ShapeType m_type = Shape::ShapeType::Count;
+    uint32_t m_index = UINT32_MAX;
+
+    explicit operator bool() const {
+        return m_type != Shape::ShapeType::Count;
+    }
+};
+
+class ShapeStorage;
+
+/**
+ * @brief rigid assembly of shapes in one body, the children are placed in
+ * the compound's local space and kept in a small static BVH
+ * @note children refer to shapes of the storage, which must outlive the
+ * compound. Compounds don't nest
+ */
+class ShapeCompound : public Shape {
+public:
+    static constexpr ShapeType Type = ShapeType::Compound;
+
+    struct Child {
+        ShapeHandle m_shape;
+        Vec2 m_position;
+        float m_rotation = 0;
+    };
+
+    /**
+     * @brief the center of mass is the area weighted center of the children
+     */
+    ShapeCompound(const ShapeStorage& shapes, const Child* children,
+                  uint32_t count);
+
+    AABB GetBounds(const Transform2D& transform) const;
+
+    bool RayCast(const Transform2D& transform, const Vec2& from,
+                 const Vec2& to, float& fraction, Vec2& normal) const;
+
+    float GetArea() const { return m_area; }
+    float GetInertia() const { return m_inertia; }
+
+    const ShapeStorage& GetShapes() const { return *m_shapes; }
+    const std::vector<Child>& GetChildren() const { return m_children; }
+
+    // placement of child i in the compound's space
+    const Transform2D& GetChildTransform(uint32_t i) const {
+        return m_childTransforms[i];
+    }
+
+    /**
+     * @brief call f with the index of every child whose bounds overlap bounds
+     * in the compound's local space
+     */
+    template <typename F>
+    void QueryChildren(const AABB& bounds, F&& f) const {
+        QueryBVH(m_nodes.data(), static_cast<uint32_t>(m_nodes.size()),
+                 bounds, f);
+    }
+
+private:
+    const ShapeStorage* m_shapes;
+    std::vector<Child> m_children;
+    std::vector<Transform2D> m_childTransforms;
+    std::vector<BVHNode> m_nodes;
+    float m_area = 0;
+    float m_inertia = 0;
+};
+
+/**
+ * @brief shapes stored by value, one pool per shape type
+ * @note shapes live as long as the storage and can be shared by bodies
+ */
+class ShapeStorage {
+public:
+    ShapeStorage() = default;
+
+    // compounds in the pools point back at their storage, a copy or a moved
+    // to storage would hold compounds reading the old one
+    ShapeStorage(const ShapeStorage&) = delete;
+    ShapeStorage(ShapeStorage&&) = delete;
+    ShapeStorage& operator=(const ShapeStorage&) = delete;
+    ShapeStorage& operator=(ShapeStorage&&) = delete;
+
+    template <typename T>
+    ShapeHandle Add(const T& shape) {
+        auto& pool = GetPool<T>();
+        pool.push_back(shape);
+        return {T::Type, static_cast<uint32_t>(pool.size() - 1)};
+    }
+
+    template <typename T>
+    std::vector<T>& GetPool() {
+        return std::get<std::vector<T>>(m_pools);
+    }
+
+    template <typename T>
+    const std::vector<T>& GetPool() const {
+        return std::get<std::vector<T>>(m_pools);
+    }
+
+    const Shape& Get(ShapeHandle handle) const;
+
+    /**
+     * @brief call f with the concrete shape handle refers to
+     */
+    template <typename F>
+    decltype(auto) Visit(ShapeHandle handle, F&& f) const {
+        switch (handle.m_type) {
+            case Shape::ShapeType::Sphere:
+                return f(GetPool<ShapeSphere>()[handle.m_index]);
+            case Shape::ShapeType::Polygon:
+                return f(GetPool<ShapePolygon>()[handle.m_index]);
+            case Shape::ShapeType::Capsule:
+                return f(GetPool<ShapeCapsule>()[handle.m_index]);
+            case Shape::ShapeType::RoundedBox:
+                return f(GetPool<ShapeRoundedBox>()[handle.m_index]);
+            case Shape::ShapeType::Compound:
+                return f(GetPool<ShapeCompound>()[handle.m_index]);
+            case Shape::ShapeType::Chain:
+                return f(GetPool<ShapeChain>()[handle.m_index]);
+            default:
+                assert(false && "invalid shape handle");
+                return f(GetPool<ShapeSphere>()[handle.m_index]);
+        }
+    }
+
+    AABB GetBounds(ShapeHandle handle, const Transform2D& transform) const;
+    float GetArea(ShapeHandle handle) const;
+    float GetInertia(ShapeHandle handle) const;
+    bool RayCast(ShapeHandle handle, const Transform2D& transform,
+                 const Vec2& from, const Vec2& to, float& fraction,
+                 Vec2& normal) const;
+
+private:
+    std::tuple<std::vector<ShapeSphere>, std::vector<ShapePolygon>,
+               std::vector<ShapeCapsule>, std::vector<ShapeRoundedBox>,
+               std::vector<ShapeCompound>, std::vector<ShapeChain>>
+        m_pools;
+};
@@ -0,0 +1,339 @@
+#include "solver.hpp"
+
+#include "macro.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// fraction of penetration removed per position iteration
+constexpr float Baumgarte = 0.2f;
+
+// penetration allowed to keep contacts alive between steps
+constexpr float LinearSlop = 0.05f;
+
+// limit of one position correction, avoids overshoot on deep penetration
+constexpr float MaxLinearCorrection = 2.0f;
+
+// constraints of one color per job
+constexpr uint32_t ColorGrainSize = 64;
+
+// velocity of the point at anchor from the center of mass
+Vec2 PointVelocity(const BodyStorage& bodies, uint32_t i,
+                   const Vec2& anchor) {
+    return bodies.m_linearVels[i] + Cross(bodies.m_angularVels[i], anchor);
+}
+
+// effective mass along direction, normal or tangent
+float NormalMass(const Vec2& direction, const Vec2& anchorA, float invMassA,
+                 float invInertiaA, const Vec2& anchorB, float invMassB,
+                 float invInertiaB) {
+    float rnA = Cross(anchorA, direction);
+    float rnB = Cross(anchorB, direction);
+    return 1.0f / (invMassA + invMassB + invInertiaA * rnA * rnA +
+                   invInertiaB * rnB * rnB);
+}
+
+/**
+ * @brief move the center of mass by translation and turn around it, the
+ * cached cos/sin are turned to first order so none are computed
+ */
+void Displace(BodyStorage& bodies, uint32_t i, const Vec2& translation,
+              float angle) {
+    Rotation2D& rotation = bodies.m_cosSins[i];
+    const Vec2& localCenter = bodies.m_localCenters[i];
+    Vec2 arm = rotation.Apply(localCenter);
+    rotation = rotation.Turn(angle);
+    bodies.m_positions[i] +=
+        translation + arm - rotation.Apply(localCenter);
+    bodies.m_rotations[i] += angle;
+}
+
+}  // namespace
+
+void ContactSolver::Prepare(BodyStorage& bodies, Manifold* const* manifolds,
+                            uint32_t count) {
+    const float* invMasses = bodies.m_invMasses.data();
+    const float* invInertias = bodies.m_invInertias.data();
+    const float* elasticities = bodies.m_elasticities.data();
+    const float* frictions = bodies.m_frictions.data();
+
+    m_constraints.clear();
+    m_colorStarts.clear();
+    for (uint32_t k = 0; k < count; ++k) {
+        Manifold* m = manifolds[k];
+        for (uint32_t i = 0; i < m->m_contactCount; ++i) {
+            const Contact& contact = m->m_contacts[i];
+            uint32_t a = contact.m_bodyA;
+            uint32_t b = contact.m_bodyB;
+            float invMassSum = invMasses[a] + invMasses[b];
+            CONTINUE_IF(invMassSum == 0);
+
+            Constraint c;
+            c.m_bodyA = a;
+            c.m_bodyB = b;
+            c.m_cachedImpulse = &m->m_normalImpulses[i];
+            c.m_cachedTangentImpulse = &m->m_tangentImpulses[i];
+            c.m_normal = contact.m_normal;
+            c.m_tangent = Vec2{c.m_normal.y, -c.m_normal.x};
+            c.m_anchorA =
+                contact.m_ptOnAWorldSpace - bodies.GetCenterOfMass(a);
+            c.m_anchorB =
+                contact.m_ptOnBWorldSpace - bodies.GetCenterOfMass(b);
+            c.m_localAnchorA =
+                bodies.GetTransform(a).ApplyInverse(contact.m_ptOnAWorldSpace);
+            c.m_localAnchorB =
+                bodies.GetTransform(b).ApplyInverse(contact.m_ptOnBWorldSpace);
+            c.m_invMassA = invMasses[a];
+            c.m_invMassB = invMasses[b];
+            // static bodies aren't turned by contacts either
+            c.m_invInertiaA = invMasses[a] != 0 ? invInertias[a] : 0;
+            c.m_invInertiaB = invMasses[b] != 0 ? invInertias[b] : 0;
+            c.m_normalMass =
+                NormalMass(c.m_normal, c.m_anchorA, c.m_invMassA,
+                           c.m_invInertiaA, c.m_anchorB, c.m_invMassB,
+                           c.m_invInertiaB);
+            c.m_tangentMass =
+                NormalMass(c.m_tangent, c.m_anchorA, c.m_invMassA,
+                           c.m_invInertiaA, c.m_anchorB, c.m_invMassB,
+                           c.m_invInertiaB);
+            c.m_friction = std::sqrt(frictions[a] * frictions[b]);
+            c.m_normalImpulse = m_warmStarting ? *c.m_cachedImpulse : 0;
+            c.m_tangentImpulse =
+                m_warmStarting ? *c.m_cachedTangentImpulse : 0;
+            c.m_bias = 0;
+
+            float vn = Dot(PointVelocity(bodies, b, c.m_anchorB) -
+                               PointVelocity(bodies, a, c.m_anchorA),
+                           c.m_normal);
+            if (vn < -RestitutionThreshold) {
+                float elasticity = elasticities[a] * elasticities[b];
+                c.m_bias = -elasticity * vn;
+            }
+
+            m_constraints.push_back(c);
+        }
+    }
+
+    // warm start after all biases are computed from the unchanged velocities
+    for (auto& c : m_constraints) {
+        CONTINUE_IF(c.m_normalImpulse == 0 && c.m_tangentImpulse == 0);
+        applyImpulse(bodies, c,
+                     c.m_normal * c.m_normalImpulse +
+                         c.m_tangent * c.m_tangentImpulse);
+    }
+}
+
+void ContactSolver::Color(size_t bodyCount) {
+    m_bodyColors.resize(bodyCount, 0);
+    uint32_t counts[MaxColors] = {};
+    for (auto& c : m_constraints) {
+        uint64_t used = 0;
+        if (c.m_invMassA != 0) {
+            used |= m_bodyColors[c.m_bodyA];
+        }
+        if (c.m_invMassB != 0) {
+            used |= m_bodyColors[c.m_bodyB];
+        }
+
+        // lowest free color, all taken falls into the last one
+        uint32_t color = MaxColors - 1;
+        for (uint32_t k = 0; k < MaxColors - 1; ++k) {
+            if (!(used & (1ull << k))) {
+                color = k;
+                break;
+            }
+        }
+        if (c.m_invMassA != 0) {
+            m_bodyColors[c.m_bodyA] |= 1ull << color;
+        }
+        if (c.m_invMassB != 0) {
+            m_bodyColors[c.m_bodyB] |= 1ull << color;
+        }
+        c.m_color = color;
+        counts[color]++;
+    }
+
+    m_colorStarts.assign(1, 0);
+    for (uint32_t k = 0; k < MaxColors; ++k) {
+        CONTINUE_IF(counts[k] == 0);
+        m_colorStarts.push_back(m_colorStarts.back() + counts[k]);
+    }
+
+    // stable counting sort by color
+    uint32_t offsets[MaxColors] = {};
+    for (uint32_t k = 1; k < MaxColors; ++k) {
+        offsets[k] = offsets[k - 1] + counts[k - 1];
+    }
+    m_colored.resize(m_constraints.size());
+    for (auto& c : m_constraints) {
+        m_colored[offsets[c.m_color]++] = c;
+    }
+    m_constraints.swap(m_colored);
+
+    // leave the masks clean for the next island
+    for (auto& c : m_constraints) {
+        m_bodyColors[c.m_bodyA] = 0;
+        m_bodyColors[c.m_bodyB] = 0;
+    }
+}
+
+void ContactSolver::SolveVelocities(BodyStorage& bodies,
+                                    JobSystem* jobSystem) {
+    uint32_t colorCount = GetColorCount();
+    if (!jobSystem || colorCount == 0) {
+        solveVelocities(bodies, 0,
+                        static_cast<uint32_t>(m_constraints.size()));
+        return;
+    }
+
+    for (uint32_t k = 0; k < colorCount; ++k) {
+        uint32_t start = m_colorStarts[k];
+        uint32_t count = m_colorStarts[k + 1] - start;
+        if (k == colorCount - 1 && m_constraints[start].m_color ==
+                                       MaxColors - 1) {
+            // the overflow color may share bodies
+            solveVelocities(bodies, start, start + count);
+            continue;
+        }
+        jobSystem->ParallelFor(
+            count, ColorGrainSize,
+            [&](uint32_t begin, uint32_t end, uint32_t) {
+                solveVelocities(bodies, start + begin, start + end);
+            });
+    }
+}
+
+bool ContactSolver::SolvePositions(BodyStorage& bodies, JobSystem* jobSystem) {
+    uint32_t colorCount = GetColorCount();
+    float minSeparation = 0;
+    if (!jobSystem || colorCount == 0) {
+        minSeparation = solvePositions(
+            bodies, 0, static_cast<uint32_t>(m_constraints.size()));
+        return minSeparation >= -3.0f * LinearSlop;
+    }
+
+    for (uint32_t k = 0; k < colorCount; ++k) {
+        uint32_t start = m_colorStarts[k];
+        uint32_t count = m_colorStarts[k + 1] - start;
+        if (k == colorCount - 1 && m_constraints[start].m_color ==
+                                       MaxColors - 1) {
+            minSeparation = std::min(
+                minSeparation,
+                solvePositions(bodies, start, start + count));
+            continue;
+        }
+        m_chunkSeparations.assign((count + ColorGrainSize - 1) /
+                                      ColorGrainSize,
+                                  0.0f);
+        jobSystem->ParallelFor(
+            count, ColorGrainSize,
+            [&](uint32_t begin, uint32_t end, uint32_t) {
+                m_chunkSeparations[begin / ColorGrainSize] =
+                    solvePositions(bodies, start + begin, start + end);
+            });
+        for (float separation : m_chunkSeparations) {
+            minSeparation = std::min(minSeparation, separation);
+        }
+    }
+    return minSeparation >= -3.0f * LinearSlop;
+}
+
+void ContactSolver::solveVelocities(BodyStorage& bodies, uint32_t begin,
+                                    uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+        auto& c = m_constraints[i];
+
+        // friction first, it is bounded by the normal impulse of the last
+        // iteration so the normal goes last and is the one that holds
+        float vt = Dot(PointVelocity(bodies, c.m_bodyB, c.m_anchorB) -
+                           PointVelocity(bodies, c.m_bodyA, c.m_anchorA),
+                       c.m_tangent);
+        float maxFriction = c.m_friction * c.m_normalImpulse;
+        float tangentTotal =
+            std::clamp(c.m_tangentImpulse - c.m_tangentMass * vt,
+                       -maxFriction, maxFriction);
+        float tangentLambda = tangentTotal - c.m_tangentImpulse;
+        c.m_tangentImpulse = tangentTotal;
+        applyImpulse(bodies, c, c.m_tangent * tangentLambda);
+
+        float vn = Dot(PointVelocity(bodies, c.m_bodyB, c.m_anchorB) -
+                           PointVelocity(bodies, c.m_bodyA, c.m_anchorA),
+                       c.m_normal);
+        float lambda = c.m_normalMass * (c.m_bias - vn);
+
+        // the total impulse may only push the bodies apart
+        float total = std::max(c.m_normalImpulse + lambda, 0.0f);
+        lambda = total - c.m_normalImpulse;
+        c.m_normalImpulse = total;
+
+        applyImpulse(bodies, c, c.m_normal * lambda);
+    }
+}
+
+float ContactSolver::solvePositions(BodyStorage& bodies, uint32_t begin,
+                                    uint32_t end) {
+    const Vec2* localCenters = bodies.m_localCenters.data();
+
+    float minSeparation = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        auto& c = m_constraints[i];
+        uint32_t a = c.m_bodyA;
+        uint32_t b = c.m_bodyB;
+
+        // the contact points moved and turned with the bodies since Prepare
+        Transform2D transformA = bodies.GetTransform(a);
+        Transform2D transformB = bodies.GetTransform(b);
+        Vec2 anchorA = transformA.m_rotation.Apply(c.m_localAnchorA -
+                                                   localCenters[a]);
+        Vec2 anchorB = transformB.m_rotation.Apply(c.m_localAnchorB -
+                                                   localCenters[b]);
+        Vec2 pointA = transformA.Apply(c.m_localAnchorA);
+        Vec2 pointB = transformB.Apply(c.m_localAnchorB);
+
+        // negative when penetrating
+        float separation = Dot(pointB - pointA, c.m_normal);
+        minSeparation = std::min(minSeparation, separation);
+
+        float correction =
+            std::clamp(Baumgarte * (separation + LinearSlop),
+                       -MaxLinearCorrection, 0.0f);
+        float normalMass =
+            NormalMass(c.m_normal, anchorA, c.m_invMassA, c.m_invInertiaA,
+                       anchorB, c.m_invMassB, c.m_invInertiaB);
+        Vec2 impulse = c.m_normal * (-correction * normalMass);
+
+        if (c.m_invMassA != 0) {
+            Displace(bodies, a, -impulse * c.m_invMassA,
+                     -c.m_invInertiaA * Cross(anchorA, impulse));
+        }
+        if (c.m_invMassB != 0) {
+            Displace(bodies, b, impulse * c.m_invMassB,
+                     c.m_invInertiaB * Cross(anchorB, impulse));
+        }
+    }
+    return minSeparation;
+}
+
+void ContactSolver::applyImpulse(BodyStorage& bodies, const Constraint& c,
+                                 const Vec2& impulse) {
+    // static bodies may be shared by islands solved on other threads, so
+    // they must not even be written with an unchanged value
+    if (c.m_invMassA != 0) {
+        bodies.m_linearVels[c.m_bodyA] -= impulse * c.m_invMassA;
+        bodies.m_angularVels[c.m_bodyA] -=
+            c.m_invInertiaA * Cross(c.m_anchorA, impulse);
+    }
+    if (c.m_invMassB != 0) {
+        bodies.m_linearVels[c.m_bodyB] += impulse * c.m_invMassB;
+        bodies.m_angularVels[c.m_bodyB] +=
+            c.m_invInertiaB * Cross(c.m_anchorB, impulse);
+    }
+}
+
+void ContactSolver::StoreImpulses() {
+    for (auto& c : m_constraints) {
+        *c.m_cachedImpulse = c.m_normalImpulse;
+        *c.m_cachedTangentImpulse = c.m_tangentImpulse;
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "body.hpp"
+#include "contact.hpp"
+#include "job_system.hpp"
+#include "manifold.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief sequential impulse solver for the contacts of one step
+ * @note impulses are accumulated over iterations and clamped so the total
+ * stays pushing, the totals are kept in the manifolds to warm start next step.
+ * Friction impulses along the contact tangent are clamped to the Coulomb cone
+ * of the normal impulse. Impulses act at the contact points, so they turn
+ * bodies as well
+ */
+class ContactSolver {
+public:
+    // slower approaches don't bounce, resting contacts would jitter otherwise
+    static constexpr float RestitutionThreshold = 1.0f;
+
+    /**
+     * @brief build constraints from manifolds and apply last step's impulses
+     */
+    void Prepare(BodyStorage& bodies, Manifold* const* manifolds,
+                 uint32_t count);
+
+    /**
+     * @brief group constraints by color, constraints of one color share no
+     * dynamic body and can be solved in parallel
+     * @note static bodies are only read, so they don't make conflicts
+     */
+    void Color(size_t bodyCount);
+
+    // 0 if not colored
+    uint32_t GetColorCount() const {
+        return m_colorStarts.empty()
+                   ? 0
+                   : static_cast<uint32_t>(m_colorStarts.size()) - 1;
+    }
+
+    /**
+     * @param jobSystem  solves the colors in parallel if constraints are
+     * colored, results don't depend on the thread count
+     */
+    void SolveVelocities(BodyStorage& bodies, JobSystem* jobSystem = nullptr);
+
+    /**
+     * @brief push penetrating bodies apart after integration, done on
+     * positions so the correction doesn't add energy to warm started impulses
+     * @return true if no contact penetrates more than the slop
+     * @note the cached cos/sin are only turned to first order, rebuild them
+     * from the rotations when done
+     */
+    bool SolvePositions(BodyStorage& bodies, JobSystem* jobSystem = nullptr);
+
+    /**
+     * @brief write accumulated impulses back to the manifolds
+     */
+    void StoreImpulses();
+
+    void SetWarmStarting(bool enable) { m_warmStarting = enable; }
+
+    bool IsWarmStarting() const { return m_warmStarting; }
+
+private:
+    struct Constraint {
+        uint32_t m_bodyA;
+        uint32_t m_bodyB;
+        float* m_cachedImpulse;  // in the manifold
+        float* m_cachedTangentImpulse;
+        Vec2 m_normal;
+        Vec2 m_tangent;
+        Vec2 m_anchorA;  // contact point relative to the center of mass
+        Vec2 m_anchorB;
+        Vec2 m_localAnchorA;  // contact point in body space
+        Vec2 m_localAnchorB;
+        float m_invMassA;
+        float m_invMassB;
+        float m_invInertiaA;
+        float m_invInertiaB;
+        float m_normalMass;
+        float m_tangentMass;
+        float m_friction;
+        float m_bias;
+        float m_normalImpulse;
+        float m_tangentImpulse;
+        uint32_t m_color;
+    };
+
+    // colors past this are put into one overflow color solved serially
+    static constexpr uint32_t MaxColors = 64;
+
+    bool m_warmStarting = true;
+    std::vector<Constraint> m_constraints;
+    std::vector<Constraint> m_colored;
+    std::vector<uint32_t> m_colorStarts;  // first constraint of each color
+    std::vector<uint64_t> m_bodyColors;   // body -> mask of used colors
+    std::vector<float> m_chunkSeparations;
+
+    void solveVelocities(BodyStorage& bodies, uint32_t begin, uint32_t end);
+    float solvePositions(BodyStorage& bodies, uint32_t begin, uint32_t end);
+
+    // apply impulse to A negated and to B at the anchors
+    static void applyImpulse(BodyStorage& bodies, const Constraint& c,
+                             const Vec2& impulse);
+};
@@ -0,0 +1,43 @@
+#include "transform.hpp"
+
+// the loops read cos/sin once and keep x and y apart so they vectorize
+
+void TransformPoints(const Transform2D& transform, const Vec2* points,
+                     uint32_t count, Vec2* out) {
+    float cos = transform.m_rotation.m_cos;
+    float sin = transform.m_rotation.m_sin;
+    float px = transform.m_position.x;
+    float py = transform.m_position.y;
+    for (uint32_t i = 0; i < count; ++i) {
+        float x = points[i].x;
+        float y = points[i].y;
+        out[i].x = cos * x - sin * y + px;
+        out[i].y = sin * x + cos * y + py;
+    }
+}
+
+void InvTransformPoints(const Transform2D& transform, const Vec2* points,
+                        uint32_t count, Vec2* out) {
+    float cos = transform.m_rotation.m_cos;
+    float sin = transform.m_rotation.m_sin;
+    float px = transform.m_position.x;
+    float py = transform.m_position.y;
+    for (uint32_t i = 0; i < count; ++i) {
+        float x = points[i].x - px;
+        float y = points[i].y - py;
+        out[i].x = cos * x + sin * y;
+        out[i].y = cos * y - sin * x;
+    }
+}
+
+void RotateVectors(const Rotation2D& rotation, const Vec2* vectors,
+                   uint32_t count, Vec2* out) {
+    float cos = rotation.m_cos;
+    float sin = rotation.m_sin;
+    for (uint32_t i = 0; i < count; ++i) {
+        float x = vectors[i].x;
+        float y = vectors[i].y;
+        out[i].x = cos * x - sin * y;
+        out[i].y = sin * x + cos * y;
+    }
+}
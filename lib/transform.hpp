@@ -0,0 +1,94 @@
+#pragma once
+#include "math/math.hpp"
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief 2D rotation kept as its cos/sin pair, applying or combining it
+ * needs no transcendental call
+ */
+struct Rotation2D {
+    float m_cos = 1;
+    float m_sin = 0;
+
+    Rotation2D() = default;
+
+    Rotation2D(float cos, float sin) : m_cos{cos}, m_sin{sin} {}
+
+    explicit Rotation2D(float angle)
+        : m_cos{std::cos(angle)}, m_sin{std::sin(angle)} {}
+
+    Vec2 Apply(const Vec2& v) const {
+        return Vec2{m_cos * v.x - m_sin * v.y, m_sin * v.x + m_cos * v.y};
+    }
+
+    Vec2 ApplyInverse(const Vec2& v) const {
+        return Vec2{m_cos * v.x + m_sin * v.y, m_cos * v.y - m_sin * v.x};
+    }
+
+    // o first, then this
+    Rotation2D operator*(const Rotation2D& o) const {
+        return {m_cos * o.m_cos - m_sin * o.m_sin,
+                m_sin * o.m_cos + m_cos * o.m_sin};
+    }
+
+    // o relative to this
+    Rotation2D InvMul(const Rotation2D& o) const {
+        return {m_cos * o.m_cos + m_sin * o.m_sin,
+                m_cos * o.m_sin - m_sin * o.m_cos};
+    }
+
+    /**
+     * @brief turned further by a small angle, to first order
+     * @note drifts off unit length, rebuild from the angle when done
+     */
+    Rotation2D Turn(float angle) const {
+        return {m_cos - angle * m_sin, m_sin + angle * m_cos};
+    }
+};
+
+/**
+ * @brief rigid placement of a body or shape: rotate, then translate
+ */
+struct Transform2D {
+    Vec2 m_position;
+    Rotation2D m_rotation;
+
+    Transform2D() = default;
+
+    Transform2D(const Vec2& position, const Rotation2D& rotation)
+        : m_position{position}, m_rotation{rotation} {}
+
+    Transform2D(const Vec2& position, float angle)
+        : m_position{position}, m_rotation{angle} {}
+
+    Vec2 Apply(const Vec2& p) const {
+        return m_rotation.Apply(p) + m_position;
+    }
+
+    Vec2 ApplyInverse(const Vec2& p) const {
+        return m_rotation.ApplyInverse(p - m_position);
+    }
+
+    // o placed in the space of this
+    Transform2D operator*(const Transform2D& o) const {
+        return {Apply(o.m_position), m_rotation * o.m_rotation};
+    }
+
+    // o seen from the space of this
+    Transform2D InvMul(const Transform2D& o) const {
+        return {ApplyInverse(o.m_position), m_rotation.InvMul(o.m_rotation)};
+    }
+};
+
+/**
+ * @brief batch versions for point arrays, out may be the input array
+ */
+void TransformPoints(const Transform2D& transform, const Vec2* points,
+                     uint32_t count, Vec2* out);
+void InvTransformPoints(const Transform2D& transform, const Vec2* points,
+                        uint32_t count, Vec2* out);
+
+// directions like normals only turn
+void RotateVectors(const Rotation2D& rotation, const Vec2* vectors,
+                   uint32_t count, Vec2* out);
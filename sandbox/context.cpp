@@ -70,7 +70,7 @@ void Context::Update() {
 
     renderer->Present();
     sceneMgr->PostUpdate();
-    physics_scene.Update(time->GetElapse() / 1000.0f);
+    physics_scene.Step(time->GetElapse() / 1000.0f);
 
     time->WaitForFps();
     time->EndRecordElapse();
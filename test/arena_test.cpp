@@ -0,0 +1,120 @@
+#include "math/math.hpp"
+#include "scene.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr size_t Size = 8;  // above the small matrix buffer
+
+Matrix<float> Filled(float value) {
+    Matrix<float> m(Size, Size, nullptr);
+    for (size_t c = 0; c < Size; c++) {
+        for (size_t r = 0; r < Size; r++) {
+            m[c][r] = value;
+        }
+    }
+    return m;
+}
+
+}  // namespace
+
+TEST(MatrixArenaTest, TemporariesInAScopeComeFromTheArena) {
+    MatrixArena arena;
+    Matrix<float> a = Filled(1);
+    {
+        MatrixArenaScope scope{&arena};
+        Matrix<float> zeros(Size, Size);
+        EXPECT_EQ(arena.GetUsedBytes(), Size * Size * sizeof(float));
+        Matrix<float> sum = a + zeros;
+        EXPECT_EQ(arena.GetUsedBytes(), 2 * Size * Size * sizeof(float));
+
+        // at most 4 x 4 elements live inside the matrix
+        Matrix<float> small(4, 4);
+        EXPECT_EQ(arena.GetUsedBytes(), 2 * Size * Size * sizeof(float));
+    }
+    arena.Reset();
+    EXPECT_EQ(arena.GetUsedBytes(), 0u);
+}
+
+TEST(MatrixArenaTest, CopiesOutliveTheArena) {
+    MatrixArena arena;
+    Matrix<float> a = Filled(2);
+    Matrix<float> kept(1, 1);
+    {
+        MatrixArenaScope scope{&arena};
+        Matrix<float> result = a * 3;
+        size_t used = arena.GetUsedBytes();
+        kept = result;
+        EXPECT_EQ(arena.GetUsedBytes(), used);
+    }
+
+    // reuse the memory the arena-backed result had
+    arena.Reset();
+    {
+        MatrixArenaScope scope{&arena};
+        Matrix<float> overwrite = a * 5;
+    }
+    for (size_t c = 0; c < Size; c++) {
+        for (size_t r = 0; r < Size; r++) {
+            EXPECT_EQ(kept[c][r], 6);
+        }
+    }
+}
+
+TEST(MatrixArenaTest, ResizingAssignmentKeepsTheGlobalAllocator) {
+    MatrixArena arena;
+    Matrix<float> a = Filled(1);
+    Matrix<float> outside(2, 2);
+    {
+        MatrixArenaScope scope{&arena};
+        outside = a + a;
+    }
+    EXPECT_EQ(arena.GetUsedBytes(), 0u);
+    EXPECT_EQ(outside.ColNum(), Size);
+    EXPECT_EQ(outside[3][5], 2);
+}
+
+TEST(MatrixArenaTest, ResetKeepsThePeak) {
+    MatrixArena arena;
+    EXPECT_EQ(arena.GetPeakBytes(), 0u);
+    {
+        MatrixArenaScope scope{&arena};
+        Matrix<float> a(Size, Size);
+        Matrix<float> b(Size, Size);
+    }
+    size_t used = arena.GetUsedBytes();
+    EXPECT_EQ(used, 2 * Size * Size * sizeof(float));
+    EXPECT_EQ(arena.GetPeakBytes(), 0u);
+
+    arena.Reset();
+    EXPECT_EQ(arena.GetUsedBytes(), 0u);
+    EXPECT_EQ(arena.GetPeakBytes(), used);
+    arena.Reset();
+    EXPECT_EQ(arena.GetPeakBytes(), 0u);
+}
+
+TEST(MatrixArenaTest, StepStatsReportTheRegisteredArena) {
+    MatrixArena arena;
+    PhysicsScene scene;
+    scene.CreateBody(ShapeSphere{1});
+    scene.Update(1.0f / 60.0f);
+    EXPECT_EQ(scene.GetStepStats().m_matrixArenaPeakBytes, 0u);
+
+    scene.SetMatrixArena(&arena);
+    // temporaries of the caller between steps count towards the next one
+    {
+        MatrixArenaScope scope{&arena};
+        Matrix<float> a(Size, Size);
+    }
+    scene.Update(1.0f / 60.0f);
+    EXPECT_EQ(scene.GetStepStats().m_matrixArenaPeakBytes,
+              Size * Size * sizeof(float));
+    EXPECT_EQ(arena.GetUsedBytes(), 0u);
+
+    scene.Update(1.0f / 60.0f);
+    EXPECT_EQ(scene.GetStepStats().m_matrixArenaPeakBytes, 0u);
+
+    scene.SetMatrixArena(nullptr);
+    scene.Update(1.0f / 60.0f);
+    EXPECT_EQ(scene.GetStepStats().m_matrixArenaPeakBytes, 0u);
+}
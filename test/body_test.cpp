@@ -0,0 +1,39 @@
+#include "body.hpp"
+#include <gtest/gtest.h>
+
+TEST(BodyTest, ImpulseAtPointTurnsAroundTheCenterOfMass) {
+    ShapeStorage shapes;
+    ShapeCompound::Child children[] = {
+        {shapes.Add(ShapePolygon::Box(1, 1)), Vec2{2, 0}}};
+    ShapeHandle compound = shapes.Add(ShapeCompound{shapes, children, 1});
+    BodyStorage bodies{shapes};
+    uint32_t index = bodies.GetIndex(bodies.Add(compound));
+    Body body{bodies, index};
+    body.Position() = Vec2{3, 4};
+    body.SetRotation(1.5707963f);
+
+    // the center of mass is (2, 0) in body space, (3, 6) in world space
+    Vec2 center = body.GetCenterOfMassWorldSpace();
+    ASSERT_NEAR(center.x, 3, 1e-5f);
+    ASSERT_NEAR(center.y, 6, 1e-5f);
+    // mass 1 over area 4, so the inverse inertia is 4 / (8 / 3)
+    ASSERT_NEAR(body.InvInertia(), 1.5f, 1e-5f);
+
+    // through the center of mass it only pushes
+    body.ApplyImpulseAtPoint(Vec2{1, 0}, center);
+    EXPECT_NEAR(body.LinearVel().x, 1, 1e-5f);
+    EXPECT_NEAR(body.AngularVel(), 0, 1e-5f);
+
+    // at the body origin, 2 above the center, it also turns the body by
+    // cross((0, -2), (1, 0)) = 2 times the inverse inertia
+    body.ApplyImpulseAtPoint(Vec2{1, 0}, body.Position());
+    EXPECT_NEAR(body.LinearVel().x, 2, 1e-5f);
+    EXPECT_NEAR(body.LinearVel().y, 0, 1e-5f);
+    EXPECT_NEAR(body.AngularVel(), 3, 1e-5f);
+
+    // a static body doesn't move
+    body.InvMass() = 0;
+    body.ApplyImpulseAtPoint(Vec2{0, 5}, Vec2{0, 0});
+    EXPECT_NEAR(body.LinearVel().y, 0, 1e-5f);
+    EXPECT_NEAR(body.AngularVel(), 3, 1e-5f);
+}
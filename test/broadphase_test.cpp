@@ -0,0 +1,137 @@
+#include "broadphase.hpp"
+#include "macro.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+constexpr uint32_t BodyCount = 400;
+constexpr float WorldSize = 1000;
+
+/**
+ * @brief the same bodies in a broadphase under test and in the brute force
+ * reference, moved, removed and reinserted together
+ */
+class BroadphaseTwin {
+public:
+    explicit BroadphaseTwin(BroadphaseType type)
+        : m_tested{CreateBroadphase(type)},
+          m_bounds(BodyCount),
+          m_inserted(BodyCount, true) {
+        for (uint32_t id = 0; id < BodyCount; id++) {
+            m_bounds[id] = randomBounds(randomPoint());
+            m_tested->Insert(id, m_bounds[id]);
+            m_reference.Insert(id, m_bounds[id]);
+        }
+    }
+
+    // move every inserted body a little, a few of them far
+    void Move() {
+        std::uniform_real_distribution<float> step{-8, 8};
+        std::uniform_int_distribution<int> teleport{0, 49};
+        for (uint32_t id = 0; id < BodyCount; id++) {
+            CONTINUE_IF(!m_inserted[id]);
+            Vec2 center = (m_bounds[id].m_min + m_bounds[id].m_max) * 0.5f;
+            center = teleport(m_rng) == 0
+                         ? randomPoint()
+                         : center + Vec2{step(m_rng), step(m_rng)};
+            m_bounds[id] = randomBounds(center);
+            m_tested->Move(id, m_bounds[id]);
+            m_reference.Move(id, m_bounds[id]);
+        }
+    }
+
+    // remove some bodies and put back some removed ones somewhere else
+    void Churn() {
+        std::uniform_int_distribution<int> pick{0, 9};
+        for (uint32_t id = 0; id < BodyCount; id++) {
+            CONTINUE_IF(pick(m_rng) != 0);
+            if (m_inserted[id]) {
+                m_tested->Remove(id);
+                m_reference.Remove(id);
+            } else {
+                m_bounds[id] = randomBounds(randomPoint());
+                m_tested->Insert(id, m_bounds[id]);
+                m_reference.Insert(id, m_bounds[id]);
+            }
+            m_inserted[id] = !m_inserted[id];
+        }
+    }
+
+    /**
+     * @brief pairs of the tested broadphase whose tight bounds overlap, the
+     * tree reports overlaps of its fat bounds too
+     */
+    std::vector<uint64_t> TestedPairs() {
+        std::vector<BroadphasePair> pairs;
+        m_tested->FindPairs(pairs);
+        std::vector<uint64_t> keys;
+        for (const BroadphasePair& pair : pairs) {
+            EXPECT_TRUE(m_inserted[pair.m_a]);
+            EXPECT_TRUE(m_inserted[pair.m_b]);
+            CONTINUE_IF(!m_bounds[pair.m_a].IsIntersect(m_bounds[pair.m_b]));
+            keys.push_back(key(pair));
+        }
+        std::sort(keys.begin(), keys.end());
+        // no pair may be reported twice
+        EXPECT_EQ(std::adjacent_find(keys.begin(), keys.end()), keys.end());
+        return keys;
+    }
+
+    std::vector<uint64_t> ReferencePairs() {
+        std::vector<BroadphasePair> pairs;
+        m_reference.FindPairs(pairs);
+        std::vector<uint64_t> keys;
+        for (const BroadphasePair& pair : pairs) {
+            keys.push_back(key(pair));
+        }
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+private:
+    BroadphasePtr m_tested;
+    BruteForceBroadphase m_reference;
+    std::vector<AABB> m_bounds;
+    std::vector<bool> m_inserted;
+    std::mt19937 m_rng{11};
+
+    Vec2 randomPoint() {
+        std::uniform_real_distribution<float> coord{0, WorldSize};
+        return Vec2{coord(m_rng), coord(m_rng)};
+    }
+
+    AABB randomBounds(const Vec2& center) {
+        std::uniform_real_distribution<float> halfSize{2, 15};
+        Vec2 extent{halfSize(m_rng), halfSize(m_rng)};
+        return AABB{center - extent, center + extent};
+    }
+
+    static uint64_t key(const BroadphasePair& pair) {
+        uint64_t a = std::min(pair.m_a, pair.m_b);
+        uint64_t b = std::max(pair.m_a, pair.m_b);
+        return (a << 32) | b;
+    }
+};
+
+}  // namespace
+
+TEST(BroadphaseTest, PairsMatchBruteForce) {
+    for (BroadphaseType type :
+         {BroadphaseType::UniformGrid, BroadphaseType::AABBTree,
+          BroadphaseType::SweepAndPrune}) {
+        SCOPED_TRACE(static_cast<int>(type));
+        BroadphaseTwin twin{type};
+        EXPECT_EQ(twin.TestedPairs(), twin.ReferencePairs());
+        for (int step = 0; step < 30; step++) {
+            twin.Move();
+            if (step % 5 == 4) {
+                twin.Churn();
+            }
+            std::vector<uint64_t> reference = twin.ReferencePairs();
+            ASSERT_FALSE(reference.empty());
+            ASSERT_EQ(twin.TestedPairs(), reference) << "step " << step;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#include "contact.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+
+TEST(CollidePolygonsTest, OffsetBoxesClipToTwoContacts) {
+    ShapePolygon box = ShapePolygon::Box(1, 1);
+    Transform2D transformA{Vec2{0, 0}, 0};
+    Transform2D transformB{Vec2{0.5f, 1.9f}, 0};
+
+    CollideCache cache;
+    Contact contacts[MaxManifoldContacts];
+    uint32_t count =
+        CollidePolygons(box, transformA, box, transformB, cache, contacts);
+    ASSERT_EQ(count, 2u);
+
+    // the bottom edge of B is clipped to the top edge of A, x in [-0.5, 1]
+    std::sort(contacts, contacts + count,
+              [](const Contact& a, const Contact& b) {
+                  return a.m_ptOnBWorldSpace.x < b.m_ptOnBWorldSpace.x;
+              });
+    float expectedX[] = {-0.5f, 1};
+    for (uint32_t i = 0; i < count; i++) {
+        SCOPED_TRACE(i);
+        const Contact& contact = contacts[i];
+        EXPECT_NEAR(contact.m_normal.x, 0, 1e-6f);
+        EXPECT_NEAR(contact.m_normal.y, 1, 1e-6f);
+        EXPECT_NEAR(contact.m_sperateDist, 0.1f, 1e-5f);
+        EXPECT_NEAR(contact.m_ptOnAWorldSpace.x, expectedX[i], 1e-5f);
+        EXPECT_NEAR(contact.m_ptOnAWorldSpace.y, 1, 1e-5f);
+        EXPECT_NEAR(contact.m_ptOnBWorldSpace.x, expectedX[i], 1e-5f);
+        EXPECT_NEAR(contact.m_ptOnBWorldSpace.y, 0.9f, 1e-5f);
+    }
+}
+
+TEST(CollidePolygonsTest, CachedAxisRejectsSeparatedPairs) {
+    ShapePolygon box = ShapePolygon::Box(1, 1);
+    Transform2D transformA{Vec2{0, 0}, 0};
+    Transform2D apart{Vec2{0.5f, 2.5f}, 0.1f};
+    Transform2D touching{Vec2{0.5f, 1.9f}, 0};
+
+    // the separating axis found is kept and is along y
+    CollideCache cache;
+    Contact contacts[MaxManifoldContacts];
+    EXPECT_EQ(CollidePolygons(box, transformA, box, apart, cache, contacts),
+              0u);
+    ASSERT_GE(cache.m_axisOwner, 0);
+    const Transform2D& owner = cache.m_axisOwner == 0 ? transformA : apart;
+    Vec2 axis = owner.m_rotation.Apply(box.m_normals[cache.m_axisEdge]);
+    EXPECT_GT(std::abs(axis.y), 0.99f);
+
+    // the cached axis alone rejects the pair and stays cached
+    CollideCache cached = cache;
+    EXPECT_EQ(CollidePolygons(box, transformA, box, apart, cached, contacts),
+              0u);
+    EXPECT_EQ(cached.m_axisOwner, cache.m_axisOwner);
+    EXPECT_EQ(cached.m_axisEdge, cache.m_axisEdge);
+
+    // once the pair touches the stale axis doesn't hide the contacts
+    EXPECT_EQ(
+        CollidePolygons(box, transformA, box, touching, cached, contacts), 2u);
+}
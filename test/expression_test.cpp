@@ -0,0 +1,109 @@
+#include "math/math.hpp"
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+
+// matrices above Matrix::SMOElemCount elements take their storage from
+// operator new[], count the calls while a test watches
+
+namespace {
+
+bool g_counting = false;
+size_t g_allocations = 0;
+
+}  // namespace
+
+void* operator new[](size_t size) {
+    if (g_counting) {
+        g_allocations++;
+    }
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete[](void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr size_t Size = 10;
+
+// counts allocations from construction until Count is called
+class AllocationCounter {
+public:
+    AllocationCounter() {
+        g_allocations = 0;
+        g_counting = true;
+    }
+
+    ~AllocationCounter() { g_counting = false; }
+
+    size_t Count() {
+        g_counting = false;
+        return g_allocations;
+    }
+};
+
+Matrix<float> Filled(float start) {
+    Matrix<float> m(Size, Size);
+    for (size_t c = 0; c < Size; c++) {
+        for (size_t r = 0; r < Size; r++) {
+            m[c][r] = start + static_cast<float>(c * Size + r);
+        }
+    }
+    return m;
+}
+
+}  // namespace
+
+TEST(ExpressionTest, ChainAllocatesOnlyTheResult) {
+    Matrix<float> a = Filled(1);
+    Matrix<float> b = Filled(-3);
+    Matrix<float> c = Filled(0.5f);
+
+    AllocationCounter counter;
+    Matrix<float> r = a * 2 - b + c;
+    EXPECT_EQ(counter.Count(), 1u);
+
+    for (size_t col = 0; col < Size; col++) {
+        for (size_t row = 0; row < Size; row++) {
+            EXPECT_EQ(r[col][row], a[col][row] * 2 - b[col][row] + c[col][row]);
+        }
+    }
+}
+
+TEST(ExpressionTest, AssignToAnOperandReusesItsStorage) {
+    Matrix<float> a = Filled(1);
+    Matrix<float> b = Filled(-3);
+    Matrix<float> expected = Filled(1);
+    for (size_t c = 0; c < Size; c++) {
+        for (size_t r = 0; r < Size; r++) {
+            expected[c][r] += b[c][r];
+        }
+    }
+
+    AllocationCounter counter;
+    a = a + b;
+    EXPECT_EQ(counter.Count(), 0u);
+    EXPECT_EQ(a, expected);
+
+    // the destination on both sides of an operator
+    AllocationCounter twice;
+    a = a * 3 - a;
+    EXPECT_EQ(twice.Count(), 0u);
+    EXPECT_EQ(a, Matrix<float>(expected * 2));
+}
+
+TEST(ExpressionTest, AssignOfAnotherSizeAllocatesOnce) {
+    Matrix<float> a(Size + 1, Size);
+    Matrix<float> b = Filled(2);
+
+    AllocationCounter counter;
+    a = b / 2;
+    EXPECT_EQ(counter.Count(), 1u);
+    EXPECT_EQ(a.ColNum(), Size);
+    EXPECT_EQ(a[3][4], b[3][4] / 2);
+}
@@ -0,0 +1,150 @@
+#include "math/math.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+// diagonally dominant, so well conditioned and never singular
+Matrix<double> RandomMatrix(size_t n, std::mt19937& rng) {
+    std::uniform_real_distribution<double> value{-1, 1};
+    Matrix<double> m(n, n);
+    for (size_t c = 0; c < n; c++) {
+        for (size_t r = 0; r < n; r++) {
+            m[c][r] = value(rng) + (c == r ? 2 : 0);
+        }
+    }
+    return m;
+}
+
+Matrix<double> Hilbert(size_t n) {
+    Matrix<double> m(n, n);
+    for (size_t c = 0; c < n; c++) {
+        for (size_t r = 0; r < n; r++) {
+            m[c][r] = 1.0 / static_cast<double>(c + r + 1);
+        }
+    }
+    return m;
+}
+
+// Laplace expansion along the first row, independent of the LU path
+double ExpansionDet(const Matrix<double>& m) {
+    size_t n = m.RowNum();
+    if (n == 1) {
+        return m[0][0];
+    }
+    double det = 0;
+    for (size_t c = 0; c < n; c++) {
+        double sign = c % 2 == 0 ? 1 : -1;
+        det += sign * m[c][0] * ExpansionDet(Cofactor(m, c, 0));
+    }
+    return det;
+}
+
+void ExpectIdentity(const Matrix<double>& m, double tolerance) {
+    for (size_t c = 0; c < m.ColNum(); c++) {
+        for (size_t r = 0; r < m.RowNum(); r++) {
+            EXPECT_NEAR(m[c][r], c == r ? 1 : 0, tolerance)
+                << "col " << c << " row " << r;
+        }
+    }
+}
+
+}  // namespace
+
+TEST(FactorizationTest, DetOfKnownMatrices) {
+    Matrix<double> diag = Matrix<double>::Diag(5, 5, 2, 3, 4, 5, 6);
+    EXPECT_DOUBLE_EQ(Det(diag), 720);
+
+    // the diagonal of 2 3 4 5 with its first two rows swapped
+    Matrix<double> swapped =
+        Matrix<double>::FromRow(4, 4, 0, 3, 0, 0, 2, 0, 0, 0, 0, 0, 4, 0, 0,
+                                0, 0, 5);
+    EXPECT_DOUBLE_EQ(Det(swapped), -120);
+
+    EXPECT_NEAR(Det(Hilbert(4)), 1 / 6048000.0, 1e-15);
+    EXPECT_NEAR(Det(Hilbert(5)), 1 / 266716800000.0, 1e-18);
+}
+
+TEST(FactorizationTest, DetMatchesExpansion) {
+    std::mt19937 rng{1};
+    for (size_t n = 1; n <= 7; n++) {
+        SCOPED_TRACE(n);
+        Matrix<double> m = RandomMatrix(n, rng);
+        double expected = ExpansionDet(m);
+        EXPECT_NEAR(Det(m), expected, 1e-12 * std::abs(expected));
+    }
+}
+
+TEST(FactorizationTest, SingularMatrices) {
+    // rows are in arithmetic progression, rank 2
+    for (size_t n : {3u, 5u, 8u}) {
+        SCOPED_TRACE(n);
+        Matrix<double> m(n, n);
+        for (size_t c = 0; c < n; c++) {
+            for (size_t r = 0; r < n; r++) {
+                m[c][r] = static_cast<double>(c + r);
+            }
+        }
+        EXPECT_NEAR(Det(m), 0, 1e-9);
+    }
+
+    // a zero column leaves no pivot at all
+    Matrix<double> zeroColumn = Matrix<double>::Identity(6, 6);
+    zeroColumn[2][2] = 0;
+    EXPECT_EQ(Det(zeroColumn), 0);
+    Matrix<double> lu = zeroColumn;
+    EXPECT_TRUE(LUDecompose(MatrixView<double, false>{lu}).singular);
+
+    Matrix<double> regular = Matrix<double>::Identity(6, 6);
+    EXPECT_FALSE(LUDecompose(MatrixView<double, false>{regular}).singular);
+}
+
+TEST(FactorizationTest, InverseTimesMatrixIsIdentity) {
+    std::mt19937 rng{2};
+    for (size_t n : {1u, 2u, 3u, 4u, 7u, 16u, 33u, 64u}) {
+        SCOPED_TRACE(n);
+        Matrix<double> m = RandomMatrix(n, rng);
+        Matrix<double> inv = Inverse(m);
+        ExpectIdentity(m * inv, 1e-10);
+        ExpectIdentity(inv * m, 1e-10);
+        EXPECT_NEAR(Det(inv) * Det(m), 1, 1e-10);
+    }
+
+    // ill conditioned but still invertible
+    Matrix<double> hilbert = Hilbert(5);
+    ExpectIdentity(hilbert * Inverse(hilbert), 1e-8);
+}
+
+TEST(FactorizationTest, CholeskySolvesSymmetricPositiveDefinite) {
+    std::mt19937 rng{3};
+    for (size_t n : {1u, 4u, 16u, 50u}) {
+        SCOPED_TRACE(n);
+        Matrix<double> a = RandomMatrix(n, rng);
+        Matrix<double> spd = Transpose(a) * a;
+
+        Matrix<double> l = spd;
+        ASSERT_TRUE(CholeskyDecompose(MatrixView<double, false>{l}));
+        Matrix<double> lu = spd;
+        LUPivots pivots = LUDecompose(MatrixView<double, false>{lu});
+        double det = LUDet(MatrixView<double, true>{lu}, pivots);
+        EXPECT_NEAR(CholeskyDet(MatrixView<double, true>{l}), det,
+                    1e-10 * std::abs(det));
+
+        Matrix<double> b = RandomMatrix(n, rng);
+        Matrix<double> x = b;
+        CholeskySolve(MatrixView<double, true>{l},
+                      MatrixView<double, false>{x});
+        Matrix<double> residual = spd * x;
+        for (size_t c = 0; c < n; c++) {
+            for (size_t r = 0; r < n; r++) {
+                EXPECT_NEAR(residual[c][r], b[c][r], 1e-9);
+            }
+        }
+        ExpectIdentity(
+            spd * CholeskyInverse(MatrixView<double, true>{l}), 1e-9);
+    }
+
+    Matrix<double> indefinite = Matrix<double>::Identity(5, 5);
+    indefinite[2][2] = -1;
+    EXPECT_FALSE(CholeskyDecompose(MatrixView<double, false>{indefinite}));
+}
@@ -0,0 +1,112 @@
+#include "job_system.hpp"
+#include "math/gemm.hpp"
+#include "math/math.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+// rows, depth, cols, none of them whole register tiles or cache blocks
+struct GemmSize {
+    size_t m;
+    size_t k;
+    size_t n;
+};
+
+constexpr GemmSize Sizes[] = {
+    {1, 1, 1},
+    {7, 5, 3},
+    {17, 33, 9},
+    {33, 129, 65},
+    {129, 257, 7},
+    {130, 3, 259},
+    {257, 300, 131},
+    {300, 259, 257},
+};
+
+template <typename T>
+Matrix<T> RandomMatrix(size_t col, size_t row, std::mt19937& rng) {
+    std::uniform_real_distribution<T> value{-1, 1};
+    Matrix<T> m(col, row);
+    for (size_t c = 0; c < col; c++) {
+        for (size_t r = 0; r < row; r++) {
+            m[c][r] = value(rng);
+        }
+    }
+    return m;
+}
+
+// naive product summed in double
+template <typename T>
+Matrix<double> NaiveProduct(const Matrix<T>& a, const Matrix<T>& b) {
+    Matrix<double> c(b.ColNum(), a.RowNum());
+    for (size_t j = 0; j < b.ColNum(); j++) {
+        for (size_t i = 0; i < a.RowNum(); i++) {
+            double sum = 0;
+            for (size_t p = 0; p < a.ColNum(); p++) {
+                sum += static_cast<double>(a[p][i]) * b[j][p];
+            }
+            c[j][i] = sum;
+        }
+    }
+    return c;
+}
+
+template <typename T>
+void CheckSizes(double tolerance) {
+    std::mt19937 rng{4};
+    JobSystem jobSystem{4};
+    for (const GemmSize& size : Sizes) {
+        SCOPED_TRACE(testing::Message() << size.m << "x" << size.k << " * "
+                                        << size.k << "x" << size.n);
+        Matrix<T> a = RandomMatrix<T>(size.k, size.m, rng);
+        Matrix<T> b = RandomMatrix<T>(size.n, size.k, rng);
+        Matrix<double> expected = NaiveProduct(a, b);
+
+        // stale values in c must be overwritten, not added to
+        Matrix<T> serial = RandomMatrix<T>(size.n, size.m, rng);
+        Gemm(MatrixView<T, true>{a}, MatrixView<T, true>{b},
+             MatrixView<T, false>{serial});
+        Matrix<T> threaded = RandomMatrix<T>(size.n, size.m, rng);
+        Gemm(MatrixView<T, true>{a}, MatrixView<T, true>{b},
+             MatrixView<T, false>{threaded}, &jobSystem);
+
+        double maxError = 0;
+        size_t mismatches = 0;
+        for (size_t c = 0; c < size.n; c++) {
+            for (size_t r = 0; r < size.m; r++) {
+                maxError = std::max(
+                    maxError, std::abs(serial[c][r] - expected[c][r]));
+                mismatches += serial[c][r] != threaded[c][r];
+            }
+        }
+        EXPECT_LT(maxError, tolerance * static_cast<double>(size.k));
+        EXPECT_EQ(mismatches, 0u) << "threads changed the result";
+    }
+}
+
+}  // namespace
+
+TEST(GemmTest, FloatMatchesNaiveProduct) { CheckSizes<float>(1e-6); }
+
+TEST(GemmTest, DoubleMatchesNaiveProduct) { CheckSizes<double>(1e-14); }
+
+TEST(GemmTest, WritesOnlyItsBlockOfC) {
+    std::mt19937 rng{5};
+    Matrix<double> a = RandomMatrix<double>(40, 37, rng);
+    Matrix<double> b = RandomMatrix<double>(21, 40, rng);
+    Matrix<double> expected = NaiveProduct(a, b);
+
+    // c is a block inside a larger matrix, so its columns are strided
+    Matrix<double> big = Matrix<double>::Zeros(25, 45);
+    Gemm(MatrixView<double, true>{a}, MatrixView<double, true>{b},
+         MatrixView<double, false>{big, 2, 21, 3, 37});
+    for (size_t c = 0; c < big.ColNum(); c++) {
+        for (size_t r = 0; r < big.RowNum(); r++) {
+            bool inside = c >= 2 && c < 23 && r >= 3 && r < 40;
+            double value = inside ? expected[c - 2][r - 3] : 0;
+            EXPECT_NEAR(big[c][r], value, 1e-12)
+                << "col " << c << " row " << r;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include "gjk.hpp"
+#include "macro.hpp"
+#include "shape.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+float PointSegmentDistance(const Vec2& p, const Vec2& a, const Vec2& b) {
+    Vec2 ab = b - a;
+    float t = std::clamp(Dot(p - a, ab) / LengthSqrd(ab), 0.0f, 1.0f);
+    return Length(p - (a + ab * t));
+}
+
+// distance of separated polygons, closest features are a vertex and an edge
+float PolygonDistance(const ShapePolygon& polyA, const Transform2D& a,
+                      const ShapePolygon& polyB, const Transform2D& b) {
+    float dist = INFINITY;
+    for (uint32_t i = 0; i < polyA.m_count; i++) {
+        Vec2 vertex = a.Apply(polyA.m_vertices[i]);
+        for (uint32_t j = 0; j < polyB.m_count; j++) {
+            Vec2 v1 = b.Apply(polyB.m_vertices[j]);
+            Vec2 v2 = b.Apply(polyB.m_vertices[(j + 1) % polyB.m_count]);
+            dist = std::min(dist, PointSegmentDistance(vertex, v1, v2));
+        }
+    }
+    for (uint32_t j = 0; j < polyB.m_count; j++) {
+        Vec2 vertex = b.Apply(polyB.m_vertices[j]);
+        for (uint32_t i = 0; i < polyA.m_count; i++) {
+            Vec2 v1 = a.Apply(polyA.m_vertices[i]);
+            Vec2 v2 = a.Apply(polyA.m_vertices[(i + 1) % polyA.m_count]);
+            dist = std::min(dist, PointSegmentDistance(vertex, v1, v2));
+        }
+    }
+    return dist;
+}
+
+}  // namespace
+
+TEST(GjkTest, BoxToSphereCenter) {
+    ShapePolygon box = ShapePolygon::Box(1, 1);
+    ShapeSphere sphere{0.5f};
+    Transform2D boxTransform{Vec2{0, 0}, 0};
+
+    // facing an edge, then a corner, radii are left out
+    struct Case {
+        Vec2 m_center;
+        float m_distance;
+        Vec2 m_pointA;
+    };
+    for (const Case& c : {Case{Vec2{3, 0.5f}, 2, Vec2{1, 0.5f}},
+                          Case{Vec2{3, 3}, std::sqrt(8.0f), Vec2{1, 1}}}) {
+        SCOPED_TRACE(c.m_distance);
+        GjkSimplex simplex;
+        GjkResult result =
+            GjkDistance(ConvexProxy{box, boxTransform},
+                        ConvexProxy{sphere, Transform2D{c.m_center, 0}},
+                        simplex);
+        EXPECT_NEAR(result.m_distance, c.m_distance, 1e-5f);
+        EXPECT_NEAR(result.m_pointA.x, c.m_pointA.x, 1e-5f);
+        EXPECT_NEAR(result.m_pointA.y, c.m_pointA.y, 1e-5f);
+        EXPECT_NEAR(result.m_pointB.x, c.m_center.x, 1e-5f);
+        EXPECT_NEAR(result.m_pointB.y, c.m_center.y, 1e-5f);
+    }
+}
+
+TEST(GjkTest, RotatedBoxesMatchBruteForce) {
+    std::mt19937 rng{3};
+    std::uniform_real_distribution<float> halfSize{0.2f, 3};
+    std::uniform_real_distribution<float> angle{0, 6.2831853f};
+    std::uniform_real_distribution<float> coord{-20, 20};
+    for (int i = 0; i < 500; i++) {
+        SCOPED_TRACE(i);
+        ShapePolygon polyA = ShapePolygon::Box(halfSize(rng), halfSize(rng));
+        ShapePolygon polyB = ShapePolygon::Box(halfSize(rng), halfSize(rng));
+        Transform2D a{Vec2{coord(rng), coord(rng)}, angle(rng)};
+        Transform2D b{Vec2{coord(rng), coord(rng)}, angle(rng)};
+        // overlapping pairs are EPA's, see below
+        CONTINUE_IF(Length(a.m_position - b.m_position) < 9);
+
+        GjkSimplex simplex;
+        ConvexProxy proxyA{polyA, a};
+        ConvexProxy proxyB{polyB, b};
+        GjkResult result = GjkDistance(proxyA, proxyB, simplex);
+        float expected = PolygonDistance(polyA, a, polyB, b);
+        EXPECT_NEAR(result.m_distance, expected, 1e-3f);
+        EXPECT_NEAR(Length(result.m_pointB - result.m_pointA), expected,
+                    1e-3f);
+
+        // warm started from its own simplex it ends at once
+        GjkResult warm = GjkDistance(proxyA, proxyB, simplex);
+        EXPECT_NEAR(warm.m_distance, expected, 1e-3f);
+        EXPECT_LE(warm.m_iterations, result.m_iterations);
+    }
+}
+
+TEST(GjkTest, EpaFindsBoxPenetration) {
+    ShapePolygon box = ShapePolygon::Box(1, 1);
+    ConvexProxy a{box, Transform2D{Vec2{0, 0}, 0}};
+    ConvexProxy b{box, Transform2D{Vec2{1.5f, 0.2f}, 0}};
+
+    GjkSimplex simplex;
+    ASSERT_EQ(GjkDistance(a, b, simplex).m_distance, 0);
+    Vec2 normal;
+    float depth = 0;
+    Vec2 pointA;
+    Vec2 pointB;
+    ASSERT_TRUE(EpaPenetration(a, b, simplex, normal, depth, pointA, pointB));
+    EXPECT_NEAR(normal.x, 1, 1e-5f);
+    EXPECT_NEAR(normal.y, 0, 1e-5f);
+    EXPECT_NEAR(depth, 0.5f, 1e-5f);
+    EXPECT_NEAR(pointA.x, 1, 1e-5f);
+    EXPECT_NEAR(pointB.x, 0.5f, 1e-5f);
+}
@@ -0,0 +1,91 @@
+#include "manifold.hpp"
+#include "scene.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+
+Contact MakeContact(const Vec2& pointA, const Vec2& pointB) {
+    Contact contact{};
+    contact.m_ptOnALocalSpace = pointA;
+    contact.m_ptOnBLocalSpace = pointB;
+    contact.m_normal = Vec2{0, 1};
+    return contact;
+}
+
+}  // namespace
+
+TEST(ManifoldCacheTest, ImpulsesLiveWhileThePairTouches) {
+    ShapeStorage shapes;
+    ShapeHandle sphere = shapes.Add(ShapeSphere{1});
+    BodyStorage bodies{shapes};
+    BodyHandle a = bodies.Add(sphere);
+    BodyHandle b = bodies.Add(sphere);
+    uint32_t indexA = bodies.GetIndex(a);
+    uint32_t indexB = bodies.GetIndex(b);
+    Contact contact = MakeContact(Vec2{0, 1}, Vec2{0, -1});
+
+    ManifoldCache cache;
+    cache.BeginStep();
+    Manifold& m = cache.Add(bodies, indexA, indexB, {}, &contact, 1);
+    EXPECT_EQ(m.m_normalImpulses[0], 0);
+    m.m_normalImpulses[0] = 3;
+    m.m_tangentImpulses[0] = -1;
+    cache.EndStep();
+
+    // the contact moved a little, its impulses carry over
+    cache.BeginStep();
+    contact = MakeContact(Vec2{0.1f, 1}, Vec2{0.1f, -1});
+    cache.Add(bodies, indexA, indexB, {}, &contact, 1);
+    cache.EndStep();
+    const Manifold* found = cache.Find(b, a);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(found->m_contactCount, 1u);
+    EXPECT_EQ(found->m_normalImpulses[0], 3);
+    EXPECT_EQ(found->m_tangentImpulses[0], -1);
+
+    // a step apart drops them even if the pair stays in the broadphase
+    cache.BeginStep();
+    cache.Add(bodies, indexA, indexB, {}, nullptr, 0);
+    cache.EndStep();
+    cache.BeginStep();
+    cache.Add(bodies, indexA, indexB, {}, &contact, 1);
+    cache.EndStep();
+    found = cache.Find(a, b);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(found->m_normalImpulses[0], 0);
+    EXPECT_EQ(found->m_tangentImpulses[0], 0);
+
+    // a pair not tested in a step is evicted
+    cache.BeginStep();
+    cache.EndStep();
+    EXPECT_FALSE(cache.Find(a, b));
+    EXPECT_EQ(cache.Size(), 0u);
+}
+
+TEST(ManifoldCacheTest, RestingContactCarriesTheWeight) {
+    constexpr float TimeStep = 1.0f / 60.0f;
+    PhysicsScene scene;
+    scene.m_gravity = Vec2{0, 100};
+    scene.SetAllowSleep(false);
+    BodyHandle ground = scene.CreateBody(ShapePolygon::Box(50, 5));
+    scene.GetBody(ground).Position() = Vec2{0, 5};
+    scene.GetBody(ground).InvMass() = 0;
+    BodyHandle ball = scene.CreateBody(ShapeSphere{1});
+    scene.GetBody(ball).Position() = Vec2{0, -1};
+    scene.GetBody(ball).Elasticity() = 0;
+
+    for (int i = 0; i < 60; i++) {
+        scene.Update(TimeStep);
+    }
+    // the solver stored the impulse holding the ball up in the cache
+    float weight = TimeStep * 100 / scene.GetBody(ball).InvMass();
+    ASSERT_EQ(scene.GetManifolds().size(), 1u);
+    const Manifold* m = scene.GetManifolds()[0];
+    ASSERT_EQ(m->m_contactCount, 1u);
+    EXPECT_NEAR(m->m_normalImpulses[0], weight, 0.05f * weight);
+
+    // lifted away from the ground the pair stops touching
+    scene.GetBody(ball).SetPosition(Vec2{0, -100});
+    scene.Update(TimeStep);
+    EXPECT_TRUE(scene.GetManifolds().empty());
+}
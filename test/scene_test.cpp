@@ -0,0 +1,261 @@
+#include "scene.hpp"
+#include <bit>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+constexpr float TimeStep = 1.0f / 60.0f;
+
+/**
+ * @brief a brick laid box pile big enough to be solved with colored
+ * constraints and spheres falling on static bumps, which make many small
+ * islands
+ */
+std::vector<BodyHandle> BuildScene(PhysicsScene& scene) {
+    scene.m_gravity = Vec2{0, 100};
+    scene.SetAllowSleep(false);
+
+    BodyHandle ground = scene.CreateBody(ShapePolygon::Box(400, 5));
+    scene.GetBody(ground).Position() = Vec2{200, 5};
+    scene.GetBody(ground).InvMass() = 0;
+
+    std::vector<BodyHandle> bodies;
+    for (int y = 0; y < 12; y++) {
+        for (int x = 0; x < 30; x++) {
+            BodyHandle box = scene.CreateBody(ShapePolygon::Box(5, 5));
+            Body body = scene.GetBody(box);
+            body.Position() =
+                Vec2{x * 10.5f + 5.25f * (y % 2), -5 - y * 10.5f};
+            body.Elasticity() = 0;
+            bodies.push_back(box);
+        }
+    }
+
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> x{1000, 5000};
+    std::uniform_real_distribution<float> y{-1500, 0};
+    std::uniform_real_distribution<float> radius{2, 5};
+    for (int i = 0; i < 20; i++) {
+        BodyHandle bump = scene.CreateBody(ShapeSphere{60});
+        scene.GetBody(bump).Position() = Vec2{1000 + i * 200.0f, 60};
+        scene.GetBody(bump).InvMass() = 0;
+    }
+    for (int i = 0; i < 1500; i++) {
+        BodyHandle sphere = scene.CreateBody(ShapeSphere{radius(rng)});
+        scene.GetBody(sphere).Position() = Vec2{x(rng), y(rng)};
+        bodies.push_back(sphere);
+    }
+    return bodies;
+}
+
+// bit patterns of the state of every body after steps
+std::vector<uint32_t> Simulate(uint32_t threadCount, uint32_t steps) {
+    PhysicsScene scene;
+    scene.SetThreadCount(threadCount);
+    std::vector<BodyHandle> bodies = BuildScene(scene);
+    for (uint32_t i = 0; i < steps; i++) {
+        scene.Update(TimeStep);
+    }
+    EXPECT_GT(scene.GetStepStats().m_largeIslandCount, 0u);
+
+    std::vector<uint32_t> state;
+    for (BodyHandle handle : bodies) {
+        Body body = scene.GetBody(handle);
+        for (float value : {body.Position().x, body.Position().y,
+                            body.LinearVel().x, body.LinearVel().y,
+                            body.Rotation(), body.AngularVel()}) {
+            state.push_back(std::bit_cast<uint32_t>(value));
+        }
+    }
+    return state;
+}
+
+/**
+ * @brief fire a bullet down at 1000 units per step through a wall whose top
+ * is at y = 0, far more than its own size
+ * @return where the bullet ends the step
+ */
+float FireBullet(PhysicsScene& scene, ShapeHandle wall, ShapeHandle bullet) {
+    scene.m_gravity = Vec2{0, 0};
+    Body wallBody = scene.GetBody(scene.CreateBody(wall));
+    if (wall.m_type == Shape::ShapeType::Polygon) {
+        wallBody.Position() = Vec2{0, 0.5f};
+    }
+    wallBody.InvMass() = 0;
+
+    BodyHandle handle = scene.CreateBody(bullet);
+    Body body = scene.GetBody(handle);
+    body.Position() = Vec2{0, -500};
+    body.LinearVel() = Vec2{0, 1000 / TimeStep};
+    body.SetBullet(true);
+    scene.Update(TimeStep);
+    return scene.GetBody(handle).Position().y;
+}
+
+/**
+ * @brief boxes of size 10 stacked on static ground whose top is at y = 0,
+ * the bottom box first
+ */
+std::vector<BodyHandle> BuildStack(PhysicsScene& scene, int height) {
+    scene.m_gravity = Vec2{0, 100};
+    BodyHandle ground = scene.CreateBody(ShapePolygon::Box(50, 5));
+    scene.GetBody(ground).Position() = Vec2{0, 5};
+    scene.GetBody(ground).InvMass() = 0;
+
+    std::vector<BodyHandle> boxes;
+    for (int i = 0; i < height; i++) {
+        BodyHandle box = scene.CreateBody(ShapePolygon::Box(5, 5));
+        scene.GetBody(box).Position() = Vec2{0, -5 - i * 10.0f};
+        scene.GetBody(box).Elasticity() = 0;
+        boxes.push_back(box);
+    }
+    return boxes;
+}
+
+}  // namespace
+
+TEST(PhysicsSceneTest, ThreadCountDoesNotChangeResults) {
+    constexpr uint32_t Steps = 90;
+    std::vector<uint32_t> serial = Simulate(1, Steps);
+    for (uint32_t threadCount : {2u, 4u, 8u}) {
+        SCOPED_TRACE(threadCount);
+        EXPECT_EQ(Simulate(threadCount, Steps), serial);
+    }
+}
+
+TEST(PhysicsSceneTest, FastBulletsStopAtThinWalls) {
+    for (bool chainWall : {false, true}) {
+        for (Shape::ShapeType type :
+             {Shape::ShapeType::Polygon, Shape::ShapeType::Capsule,
+              Shape::ShapeType::RoundedBox, Shape::ShapeType::Compound}) {
+            SCOPED_TRACE(static_cast<int>(type));
+            PhysicsScene scene;
+            Vec2 points[] = {Vec2{-100, 0}, Vec2{100, 0}};
+            ShapeHandle wall =
+                chainWall ? scene.CreateShape(ShapeChain{points, 2})
+                          : scene.CreateShape(ShapePolygon::Box(100, 0.5f));
+            ShapeHandle box = scene.CreateShape(ShapePolygon::Box(0.5f, 0.5f));
+            ShapeCompound::Child children[] = {{box, Vec2{-1, 0}},
+                                               {box, Vec2{1, 0}}};
+            ShapeHandle bullet = box;
+            if (type == Shape::ShapeType::Capsule) {
+                bullet = scene.CreateShape(
+                    ShapeCapsule{Vec2{-0.5f, 0}, Vec2{0.5f, 0}, 0.2f});
+            } else if (type == Shape::ShapeType::RoundedBox) {
+                bullet = scene.CreateShape(ShapeRoundedBox{0.3f, 0.3f, 0.2f});
+            } else if (type == Shape::ShapeType::Compound) {
+                bullet = scene.CreateShape(
+                    ShapeCompound{scene.GetShapes(), children, 2});
+            }
+            EXPECT_LT(FireBullet(scene, wall, bullet), 0);
+        }
+    }
+}
+
+TEST(PhysicsSceneTest, NewBodiesInterpolateFromWhereTheyArePlaced) {
+    PhysicsScene scene;
+    scene.m_gravity = Vec2{0, 100};
+    BodyHandle handle = scene.CreateBody(ShapeSphere{1});
+    scene.GetBody(handle).Position() = Vec2{10, 20};
+    scene.GetBody(handle).SetRotation(1);
+
+    // too short for a fixed step, the body is drawn where it was placed
+    EXPECT_EQ(scene.Step(0.5f * TimeStep), 0u);
+    float alpha = scene.GetInterpolationAlpha();
+    Body body = scene.GetBody(handle);
+    EXPECT_EQ(body.GetInterpolatedPosition(alpha).x, 10);
+    EXPECT_EQ(body.GetInterpolatedPosition(alpha).y, 20);
+    EXPECT_EQ(body.GetInterpolatedRotation(alpha), 1);
+
+    // a teleport isn't blended with the old position either
+    EXPECT_EQ(scene.Step(TimeStep), 1u);
+    scene.GetBody(handle).SetPosition(Vec2{-50, 0});
+    alpha = scene.GetInterpolationAlpha();
+    Vec2 drawn = scene.GetBody(handle).GetInterpolatedPosition(alpha);
+    EXPECT_EQ(drawn.x, -50);
+    EXPECT_EQ(drawn.y, 0);
+}
+
+TEST(PhysicsSceneTest, DestroyedHandlesGoStale) {
+    PhysicsScene scene;
+    BodyHandle first = scene.CreateBody(ShapeSphere{1});
+    BodyHandle middle = scene.CreateBody(ShapeSphere{1});
+    BodyHandle last = scene.CreateBody(ShapeSphere{1});
+    scene.GetBody(middle).Position() = Vec2{10, 0};
+    scene.GetBody(last).Position() = Vec2{20, 0};
+
+    // the last body is moved into the first one's place
+    EXPECT_TRUE(scene.DestroyBody(first));
+    EXPECT_FALSE(scene.IsValid(first));
+    EXPECT_FALSE(scene.GetBody(first));
+    EXPECT_FALSE(scene.DestroyBody(first));
+    ASSERT_TRUE(scene.IsValid(last));
+    EXPECT_EQ(scene.GetBody(last).Position().x, 20);
+    ASSERT_TRUE(scene.IsValid(middle));
+    EXPECT_EQ(scene.GetBody(middle).Position().x, 10);
+
+    // the freed slot is reused with a new generation
+    BodyHandle reused = scene.CreateBody(ShapeSphere{1});
+    EXPECT_EQ(reused.m_index, first.m_index);
+    EXPECT_NE(reused.m_generation, first.m_generation);
+    EXPECT_TRUE(scene.IsValid(reused));
+    EXPECT_FALSE(scene.IsValid(first));
+    EXPECT_EQ(scene.GetBody(last).Position().x, 20);
+}
+
+TEST(PhysicsSceneTest, BoxStackSettles) {
+    PhysicsScene scene;
+    scene.SetAllowSleep(false);
+    std::vector<BodyHandle> boxes = BuildStack(scene, 5);
+    for (int i = 0; i < 300; i++) {
+        scene.Update(TimeStep);
+    }
+
+    for (size_t i = 0; i < boxes.size(); i++) {
+        SCOPED_TRACE(i);
+        Body box = scene.GetBody(boxes[i]);
+        EXPECT_NEAR(box.Position().x, 0, 0.5f);
+        EXPECT_NEAR(box.Position().y, -5 - i * 10.0f, 0.5f);
+        EXPECT_NEAR(box.Rotation(), 0, 0.01f);
+        EXPECT_NEAR(box.LinearVel().x, 0, 0.1f);
+        EXPECT_NEAR(box.LinearVel().y, 0, 0.1f);
+        EXPECT_NEAR(box.AngularVel(), 0, 0.01f);
+    }
+}
+
+TEST(PhysicsSceneTest, ImpulseWakesTheSleepingStack) {
+    PhysicsScene scene;
+    std::vector<BodyHandle> boxes = BuildStack(scene, 5);
+    for (int i = 0; i < 600; i++) {
+        scene.Update(TimeStep);
+    }
+    for (BodyHandle box : boxes) {
+        EXPECT_FALSE(scene.GetBody(box).IsAwake());
+    }
+
+    // pushing the top box wakes the bottom one too, they share an island
+    scene.GetBody(boxes.back()).ApplyLinearImpulse(Vec2{10, 0});
+    for (BodyHandle box : boxes) {
+        EXPECT_TRUE(scene.GetBody(box).IsAwake());
+    }
+    scene.Update(TimeStep);
+    EXPECT_GT(scene.GetBody(boxes.back()).LinearVel().x, 0);
+}
+
+TEST(PhysicsSceneTest, ChainBodiesAreStatic) {
+    PhysicsScene scene;
+    scene.m_gravity = Vec2{0, 100};
+    Vec2 points[] = {Vec2{-100, 0}, Vec2{100, 0}};
+    BodyHandle ground = scene.CreateBody(ShapeChain{points, 2});
+    EXPECT_EQ(scene.GetBody(ground).InvMass(), 0);
+
+    BodyHandle ball = scene.CreateBody(ShapeSphere{1});
+    scene.GetBody(ball).Position() = Vec2{0, -1};
+    for (int i = 0; i < 60; i++) {
+        scene.Update(TimeStep);
+    }
+    EXPECT_EQ(scene.GetBody(ground).Position().y, 0);
+    EXPECT_EQ(scene.GetBody(ground).LinearVel().y, 0);
+    EXPECT_LT(scene.GetBody(ball).Position().y, 0);
+}
@@ -0,0 +1,116 @@
+#include "shape.hpp"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <memory>
+
+TEST(ShapeCompoundTest, TwoBoxesMassLikeOneBox) {
+    ShapeStorage shapes;
+    ShapeHandle box = shapes.Add(ShapePolygon::Box(1, 1));
+    // side by side they cover [-1, 3] x [-1, 1], the quarter turn of the
+    // second one changes nothing for a square
+    ShapeCompound::Child children[] = {{box, Vec2{0, 0}},
+                                       {box, Vec2{2, 0}, 1.5707963f}};
+    ShapeCompound compound{shapes, children, 2};
+    ShapePolygon whole = ShapePolygon::Box(2, 1);
+
+    EXPECT_NEAR(compound.GetArea(), whole.GetArea(), 1e-4f);
+    EXPECT_NEAR(compound.GetCenterOfMass().x, 1, 1e-5f);
+    EXPECT_NEAR(compound.GetCenterOfMass().y, 0, 1e-5f);
+    // area * (width^2 + height^2) / 12 about the center of mass
+    EXPECT_NEAR(compound.GetInertia(), 8.0f * (16 + 4) / 12, 1e-3f);
+    EXPECT_NEAR(compound.GetInertia(), whole.GetInertia(), 1e-3f);
+}
+
+TEST(ShapeCompoundTest, CenterOfMassIsAreaWeighted) {
+    constexpr float Pi = 3.14159265f;
+    ShapeStorage shapes;
+    ShapeCompound::Child children[] = {
+        {shapes.Add(ShapePolygon::Box(1, 1)), Vec2{4, 0}},
+        {shapes.Add(ShapeSphere{1}), Vec2{0, 3}},
+    };
+    ShapeCompound compound{shapes, children, 2};
+
+    float area = 4 + Pi;
+    Vec2 center = Vec2{4 * 4, 3 * Pi} / area;
+    EXPECT_NEAR(compound.GetArea(), area, 1e-4f);
+    EXPECT_NEAR(compound.GetCenterOfMass().x, center.x, 1e-5f);
+    EXPECT_NEAR(compound.GetCenterOfMass().y, center.y, 1e-5f);
+
+    // parallel axis theorem over both children
+    float inertia = 4.0f * 8 / 12 + 4 * LengthSqrd(Vec2{4, 0} - center) +
+                    Pi / 2 + Pi * LengthSqrd(Vec2{0, 3} - center);
+    EXPECT_NEAR(compound.GetInertia(), inertia, 1e-3f);
+}
+
+namespace {
+
+std::optional<ShapeChain> ReadBlob(const std::vector<uint8_t>& blob) {
+    auto owner = std::make_shared<std::vector<uint8_t>>(blob);
+    return ShapeChain::FromBlob(owner, owner->data(), owner->size());
+}
+
+// read blob after change was applied to the BVH node at offset
+template <typename F>
+std::optional<ShapeChain> ReadWithNode(std::vector<uint8_t> blob,
+                                       size_t offset, F&& change) {
+    BVHNode node;
+    std::memcpy(&node, blob.data() + offset, sizeof(node));
+    change(node);
+    std::memcpy(blob.data() + offset, &node, sizeof(node));
+    return ReadBlob(blob);
+}
+
+}  // namespace
+
+TEST(ShapeChainTest, FromBlobRejectsCorruptBlobs) {
+    Vec2 points[] = {Vec2{0, 0}, Vec2{10, 0}, Vec2{20, 5}, Vec2{30, 5}};
+    ShapeChain chain{points, 4, false, false};
+    std::vector<uint8_t> blob;
+    chain.WriteBlob(blob);
+
+    std::optional<ShapeChain> read = ReadBlob(blob);
+    ASSERT_TRUE(read);
+    ASSERT_EQ(read->GetSegmentCount(), chain.GetSegmentCount());
+    for (uint32_t i = 0; i < chain.GetSegmentCount(); i++) {
+        Vec2 v1, v2, r1, r2;
+        chain.GetSegment(i, v1, v2);
+        read->GetSegment(i, r1, r2);
+        EXPECT_EQ(r1.x, v1.x);
+        EXPECT_EQ(r1.y, v1.y);
+        EXPECT_EQ(r2.x, v2.x);
+        EXPECT_EQ(r2.y, v2.y);
+    }
+
+    for (size_t size : {size_t{0}, size_t{8}, blob.size() - 1}) {
+        SCOPED_TRACE(size);
+        std::vector<uint8_t> truncated{blob.begin(), blob.begin() + size};
+        EXPECT_FALSE(ReadBlob(truncated));
+    }
+    std::vector<uint8_t> longer = blob;
+    longer.push_back(0);
+    EXPECT_FALSE(ReadBlob(longer));
+
+    // the magic comes first and the version after it
+    for (size_t offset : {size_t{0}, sizeof(uint32_t)}) {
+        SCOPED_TRACE(offset);
+        std::vector<uint8_t> corrupt = blob;
+        corrupt[offset] ^= 0xFF;
+        EXPECT_FALSE(ReadBlob(corrupt));
+    }
+
+    // the BVH nodes end the blob, break the links of each in turn
+    uint32_t nodeCount = 2 * chain.GetSegmentCount() - 1;
+    size_t nodesOffset = blob.size() - nodeCount * sizeof(BVHNode);
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        SCOPED_TRACE(i);
+        size_t offset = nodesOffset + i * sizeof(BVHNode);
+        EXPECT_FALSE(ReadWithNode(blob, offset, [&](BVHNode& node) {
+            node.m_next = nodeCount + 1;
+        }));
+        EXPECT_FALSE(ReadWithNode(blob, offset,
+                                  [&](BVHNode& node) { node.m_next = i; }));
+        EXPECT_FALSE(ReadWithNode(blob, offset, [&](BVHNode& node) {
+            node.m_item = chain.GetSegmentCount();
+        }));
+    }
+}
@@ -0,0 +1,90 @@
+#include "math/math.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+// the SSE/AVX overloads of Vec4 and Mat44 are plain functions, naming the
+// template arguments calls the generic templates they replace
+
+namespace {
+
+constexpr int Rounds = 1000;
+
+class SMatrixTest : public testing::Test {
+protected:
+    float Random() { return m_value(m_rng); }
+
+    Vec4 RandomVec4() { return Vec4{Random(), Random(), Random(), Random()}; }
+
+    // kept away from zero so it can be a divisor
+    Vec4 RandomDivisor() {
+        Vec4 v = RandomVec4();
+        for (size_t i = 0; i < 4; i++) {
+            v[i] += v[i] < 0 ? -1 : 1;
+        }
+        return v;
+    }
+
+    Mat44 RandomMat44() {
+        Mat44 m;
+        for (size_t c = 0; c < 4; c++) {
+            m[c] = RandomVec4();
+        }
+        return m;
+    }
+
+    std::mt19937 m_rng{11};
+    std::uniform_real_distribution<float> m_value{-10, 10};
+};
+
+void ExpectEqual(const Vec4& simd, const Vec4& scalar) {
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_EQ(simd[i], scalar[i]) << "lane " << i;
+    }
+}
+
+// summing in another order may round the last bits differently
+void ExpectNear(const Vec4& simd, const Vec4& scalar) {
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_NEAR(simd[i], scalar[i], 1e-5f * (1 + std::abs(scalar[i])))
+            << "lane " << i;
+    }
+}
+
+}  // namespace
+
+TEST_F(SMatrixTest, VectorOperationsMatchScalar) {
+    for (int i = 0; i < Rounds; i++) {
+        Vec4 a = RandomVec4();
+        Vec4 b = RandomDivisor();
+        float s = Random();
+        float d = b[0];
+        ExpectEqual(a + b, operator+ <float, 4>(a, b));
+        ExpectEqual(a - b, operator- <float, 4>(a, b));
+        ExpectEqual(a * b, operator* <float, 4>(a, b));
+        ExpectEqual(a / b, operator/ <float, 4>(a, b));
+        ExpectEqual(a * s, operator* <float, float, 4>(a, s));
+        ExpectEqual(s * a, operator* <float, float, 4>(s, a));
+        ExpectEqual(a / d, operator/ <float, float, 4>(a, d));
+    }
+}
+
+TEST_F(SMatrixTest, MatrixVectorProductMatchesScalar) {
+    for (int i = 0; i < Rounds; i++) {
+        Mat44 m = RandomMat44();
+        Vec4 v = RandomVec4();
+        ExpectNear(m * v, operator* <float, 4, 4>(m, v));
+    }
+}
+
+TEST_F(SMatrixTest, MatrixProductMatchesScalar) {
+    for (int i = 0; i < Rounds; i++) {
+        Mat44 m1 = RandomMat44();
+        Mat44 m2 = RandomMat44();
+        Mat44 simd = m1 * m2;
+        Mat44 scalar = operator* <float, 4, 4, 4>(m1, m2);
+        for (size_t c = 0; c < 4; c++) {
+            SCOPED_TRACE(c);
+            ExpectNear(simd[c], scalar[c]);
+        }
+    }
+}
@@ -0,0 +1,173 @@
+#include "job_system.hpp"
+#include "math/math.hpp"
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+
+namespace {
+
+constexpr size_t Grid = 6;
+constexpr size_t Size = Grid * Grid;
+
+// 2D Laplacian on a grid plus a diagonal shift, symmetric positive definite
+std::vector<SparseEntry<double>> GridEntries() {
+    std::vector<SparseEntry<double>> entries;
+    for (size_t i = 0; i < Grid; i++) {
+        for (size_t j = 0; j < Grid; j++) {
+            size_t r = i * Grid + j;
+            entries.push_back({r, r, 4.5});
+            if (i > 0) entries.push_back({r - Grid, r, -1});
+            if (i + 1 < Grid) entries.push_back({r + Grid, r, -1});
+            if (j > 0) entries.push_back({r - 1, r, -1});
+            if (j + 1 < Grid) entries.push_back({r + 1, r, -1});
+        }
+    }
+    return entries;
+}
+
+Matrix<double> ToDense(const SparseMatrix<double>& a) {
+    Matrix<double> dense(a.ColNum(), a.RowNum());
+    for (size_t r = 0; r < a.RowNum(); r++) {
+        for (uint32_t k = a.RowStarts()[r]; k < a.RowStarts()[r + 1]; k++) {
+            dense[a.ColIndices()[k]][r] = a.Values()[k];
+        }
+    }
+    return dense;
+}
+
+std::vector<double> RandomVector(size_t n, std::mt19937& rng) {
+    std::uniform_real_distribution<double> value{-1, 1};
+    std::vector<double> v(n);
+    for (double& x : v) {
+        x = value(rng);
+    }
+    return v;
+}
+
+// the dense LU solution as the reference
+std::vector<double> DenseSolve(const SparseMatrix<double>& a,
+                               const std::vector<double>& b) {
+    Matrix<double> lu = ToDense(a);
+    LUPivots pivots = LUDecompose(MatrixView<double, false>{lu});
+    EXPECT_FALSE(pivots.singular);
+    Matrix<double> x(1, b.size());
+    for (size_t r = 0; r < b.size(); r++) {
+        x[0][r] = b[r];
+    }
+    LUSolve(MatrixView<double, true>{lu}, pivots,
+            MatrixView<double, false>{x});
+    return std::vector<double>(x.Ptr(), x.Ptr() + b.size());
+}
+
+void ExpectNear(const std::vector<double>& x, const std::vector<double>& y,
+                double tolerance) {
+    ASSERT_EQ(x.size(), y.size());
+    for (size_t i = 0; i < x.size(); i++) {
+        EXPECT_NEAR(x[i], y[i], tolerance) << "element " << i;
+    }
+}
+
+}  // namespace
+
+TEST(SparseTest, FromEntriesSumsDuplicatesAndMulMatchesDense) {
+    std::mt19937 rng{1};
+    std::vector<SparseEntry<double>> entries = GridEntries();
+    // split every diagonal entry in two, out of order
+    for (size_t r = Size; r-- > 0;) {
+        entries.push_back({r, r, -0.5});
+        entries.push_back({r, r, 0.5});
+    }
+    SparseMatrix<double> a =
+        SparseMatrix<double>::FromEntries(Size, Size, entries);
+    EXPECT_EQ(a.NonZeroCount(), Size + 4 * Grid * (Grid - 1));
+    EXPECT_EQ(a.Diagonal(7), 4.5);
+
+    std::vector<double> x = RandomVector(Size, rng);
+    std::vector<double> y;
+    Mul(a, x, y);
+    Matrix<double> dense = ToDense(a);
+    for (size_t r = 0; r < Size; r++) {
+        double sum = 0;
+        for (size_t c = 0; c < Size; c++) {
+            sum += dense[c][r] * x[c];
+        }
+        EXPECT_NEAR(y[r], sum, 1e-12);
+    }
+}
+
+TEST(SparseTest, SolversMatchLUSolve) {
+    std::mt19937 rng{2};
+    SparseMatrix<double> a =
+        SparseMatrix<double>::FromEntries(Size, Size, GridEntries());
+    std::vector<double> b = RandomVector(Size, rng);
+    std::vector<double> expected = DenseSolve(a, b);
+
+    std::vector<double> cg(Size, 0);
+    IterativeSolveResult result = ConjugateGradient(a, b, cg, 100, 1e-12);
+    EXPECT_LE(result.iterations, Size);
+    EXPECT_LT(result.residual, 1e-12);
+    ExpectNear(cg, expected, 1e-10);
+
+    // rows are split across threads, each summed by one
+    JobSystem jobSystem{4};
+    std::vector<double> threaded(Size, 0);
+    ConjugateGradient(a, b, threaded, 100, 1e-12, &jobSystem);
+    EXPECT_EQ(threaded, cg);
+
+    // unbounded PGS is plain Gauss-Seidel
+    constexpr double Inf = std::numeric_limits<double>::infinity();
+    std::vector<double> lo(Size, -Inf);
+    std::vector<double> hi(Size, Inf);
+    std::vector<double> pgs(Size, 0);
+    result = ProjectedGaussSeidel(a, b, lo, hi, pgs, 1000, 1e-13);
+    EXPECT_LT(result.iterations, 1000u);
+    ExpectNear(pgs, expected, 1e-10);
+}
+
+TEST(SparseTest, ProjectedGaussSeidelWithActiveBounds) {
+    // known solution of a two contact problem: the second impulse would be
+    // negative, so it stays at its lower bound of 0
+    std::vector<SparseEntry<double>> entries{
+        {0, 0, 2}, {1, 0, 1}, {0, 1, 1}, {1, 1, 2}};
+    SparseMatrix<double> contacts =
+        SparseMatrix<double>::FromEntries(2, 2, entries);
+    std::vector<double> x{0, 0};
+    ProjectedGaussSeidel(contacts, {1, -1}, {0, 0}, {10, 10}, x, 100, 1e-12);
+    ExpectNear(x, {0.5, 0}, 1e-9);
+
+    // tight boxes on the grid, the result must satisfy the box
+    // complementarity conditions of w = a * x - b:
+    // lo < x < hi needs w = 0, x = lo needs w >= 0, x = hi needs w <= 0
+    std::mt19937 rng{3};
+    SparseMatrix<double> a =
+        SparseMatrix<double>::FromEntries(Size, Size, GridEntries());
+    std::vector<double> b = RandomVector(Size, rng);
+    std::vector<double> lo(Size, -0.1);
+    std::vector<double> hi(Size, 0.15);
+    std::vector<double> bounded(Size, 0);
+    IterativeSolveResult result =
+        ProjectedGaussSeidel(a, b, lo, hi, bounded, 1000, 1e-13);
+    EXPECT_LT(result.iterations, 1000u);
+
+    std::vector<double> w;
+    Mul(a, bounded, w);
+    size_t atLo = 0;
+    size_t atHi = 0;
+    for (size_t i = 0; i < Size; i++) {
+        SCOPED_TRACE(i);
+        w[i] -= b[i];
+        ASSERT_GE(bounded[i], lo[i]);
+        ASSERT_LE(bounded[i], hi[i]);
+        if (bounded[i] == lo[i]) {
+            atLo++;
+            EXPECT_GE(w[i], -1e-9);
+        } else if (bounded[i] == hi[i]) {
+            atHi++;
+            EXPECT_LE(w[i], 1e-9);
+        } else {
+            EXPECT_NEAR(w[i], 0, 1e-9);
+        }
+    }
+    EXPECT_GT(atLo, 0u);
+    EXPECT_GT(atHi, 0u);
+}